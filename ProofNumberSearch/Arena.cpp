@@ -0,0 +1,110 @@
+#include "Arena.h"
+#include <assert.h>
+
+Arena::Arena() : blocks(nullptr), blockCount(0), blockCapacity(0), currentBlock(-1), offset(0), bytesBefore(0), bytesReserved(0), peakBytesInUse(0), allocations(0) {
+}
+
+Arena::~Arena() {
+	for (int i = 0; i < blockCount; i++) {
+		delete[] blocks[i].memory;
+	}
+	delete[] blocks;
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment) {
+	assert((alignment & (alignment - 1)) == 0);
+	std::size_t start = (offset + alignment - 1) & ~(alignment - 1);
+	if (currentBlock < 0 || start + size > blocks[currentBlock].size) {
+		advanceBlock(size);
+		start = 0;
+	}
+	offset = start + size;
+	allocations++;
+	if (bytesBefore + offset > peakBytesInUse) {
+		peakBytesInUse = bytesBefore + offset;
+	}
+	return blocks[currentBlock].memory + start;
+}
+
+Arena::Marker Arena::mark() const {
+	Marker marker;
+	marker.block = currentBlock;
+	marker.offset = offset;
+	marker.bytesBefore = bytesBefore;
+	return marker;
+}
+
+void Arena::release(const Marker& marker) {
+	assert(marker.block <= currentBlock);
+	currentBlock = marker.block;
+	offset = marker.offset;
+	bytesBefore = marker.bytesBefore;
+}
+
+void Arena::reset() {
+	currentBlock = -1;
+	offset = 0;
+	bytesBefore = 0;
+}
+
+void Arena::swap(Arena& other) {
+	std::swap(blocks, other.blocks);
+	std::swap(blockCount, other.blockCount);
+	std::swap(blockCapacity, other.blockCapacity);
+	std::swap(currentBlock, other.currentBlock);
+	std::swap(offset, other.offset);
+	std::swap(bytesBefore, other.bytesBefore);
+	std::swap(bytesReserved, other.bytesReserved);
+	std::swap(peakBytesInUse, other.peakBytesInUse);
+	std::swap(allocations, other.allocations);
+}
+
+Arena::Stats Arena::getStats() const {
+	Stats stats;
+	stats.allocations = allocations;
+	stats.bytesInUse = bytesBefore + offset;
+	stats.peakBytesInUse = peakBytesInUse;
+	stats.bytesReserved = bytesReserved;
+	stats.blocks = blockCount;
+	return stats;
+}
+
+void Arena::advanceBlock(std::size_t minSize) {
+	if (currentBlock >= 0) {
+		bytesBefore += blocks[currentBlock].size;
+	}
+	currentBlock++;
+	offset = 0;
+	if (currentBlock < blockCount && blocks[currentBlock].size >= minSize) {
+		return;
+	}
+	std::size_t size = ARENA_INITIAL_BLOCK_SIZE;
+	if (blockCount > 0) {
+		size = blocks[blockCount - 1].size * 2;
+		if (size > ARENA_MAX_BLOCK_SIZE) {
+			size = ARENA_MAX_BLOCK_SIZE;
+		}
+	}
+	if (size < minSize) {
+		size = minSize;
+	}
+	if (currentBlock < blockCount) {
+		bytesReserved -= blocks[currentBlock].size;
+		delete[] blocks[currentBlock].memory;
+	} else {
+		if (blockCount == blockCapacity) {
+			int capacity = blockCapacity == 0 ? 8 : blockCapacity * 2;
+			Block* grown = new Block[capacity];
+			for (int i = 0; i < blockCount; i++) {
+				grown[i] = blocks[i];
+			}
+			delete[] blocks;
+			blocks = grown;
+			blockCapacity = capacity;
+		}
+		blockCount++;
+	}
+	blocks[currentBlock].memory = new char[size];
+	blocks[currentBlock].size = size;
+	bytesReserved += size;
+}
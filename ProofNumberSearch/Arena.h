@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#define ARENA_INITIAL_BLOCK_SIZE (64 * 1024)
+#define ARENA_MAX_BLOCK_SIZE (4 * 1024 * 1024)
+
+class Arena {
+public:
+	struct Marker {
+		int block;
+		std::size_t offset;
+		std::size_t bytesBefore;
+	};
+	struct Stats {
+		std::size_t allocations;
+		std::size_t bytesInUse;
+		std::size_t peakBytesInUse;
+		std::size_t bytesReserved;
+		int blocks;
+	};
+	Arena();
+	~Arena();
+	Arena(const Arena& other) = delete;
+	Arena& operator=(const Arena& other) = delete;
+	void* allocate(std::size_t size, std::size_t alignment);
+	template<typename T, typename... Args>
+	T* create(Args&&... args) {
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+	template<typename T>
+	T* allocateArray(std::size_t count) {
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+	Marker mark() const;
+	void release(const Marker& marker);
+	void reset();
+	void swap(Arena& other);
+	Stats getStats() const;
+private:
+	struct Block {
+		char* memory;
+		std::size_t size;
+	};
+	Block* blocks;
+	int blockCount;
+	int blockCapacity;
+	int currentBlock;
+	std::size_t offset;
+	std::size_t bytesBefore;
+	std::size_t bytesReserved;
+	std::size_t peakBytesInUse;
+	std::size_t allocations;
+	void advanceBlock(std::size_t minSize);
+};
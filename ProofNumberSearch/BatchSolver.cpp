@@ -0,0 +1,67 @@
+#include "BatchSolver.h"
+#include "Engine.h"
+#include "SolveRequest.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+BatchSolver::BatchSolver(const SolverOptions& options, SolveRequest** requests, int count, SolvedDatabase* database) : options(options), requests(requests), count(count), database(database),
+	workerCount(std::max(1, std::min(options.threads, count))), nextRequest(0), nextToPrint(0) {
+	this->options.threads = 1;
+	this->options.tableSizeInBytes = options.tableSizeInBytes / workerCount;
+}
+
+void BatchSolver::run() {
+	std::thread* workers = new std::thread[workerCount - 1];
+	for (int i = 0; i < workerCount - 1; i++) {
+		workers[i] = std::thread(&BatchSolver::work, this);
+	}
+	work();
+	for (int i = 0; i < workerCount - 1; i++) {
+		workers[i].join();
+	}
+	delete[] workers;
+	if (options.printStatsTotal) {
+		fflush(stdout);
+		totalStats.print(stderr, "total");
+	}
+}
+
+void BatchSolver::work() {
+	TranspositionTable table(options.tableSizeInBytes);
+	SolverOptions requestOptions = options;
+	for (int index = nextRequest++; index < count; index = nextRequest++) {
+		SolveRequest* request = requests[index];
+		if (request->valid) {
+			requestOptions.algorithm = request->algorithm;
+			table.newSearch();
+			NmkEngine engine(request->board, request->minToWin, request->player, table, requestOptions);
+			engine.setTimeLimit(options.timeLimit);
+			engine.setReportMove(request->reportMove);
+			engine.setDatabase(database);
+			request->result = engine.solveWithRetries(options.retries);
+			engine.writeResult(request->result, request->response, MAX_RESPONSE_LENGTH);
+			request->stats = engine.getStats();
+		}
+		finish(request);
+	}
+}
+
+void BatchSolver::finish(SolveRequest* request) {
+	std::lock_guard<std::mutex> guard(outputLock);
+	request->done = true;
+	while (nextToPrint < count && requests[nextToPrint]->done) {
+		SolveRequest* next = requests[nextToPrint++];
+		if (next->valid) {
+			printf("%s", next->response);
+			if (options.printStats) {
+				fflush(stdout);
+				next->stats.print(stderr, next->command);
+			}
+			totalStats.add(next->stats);
+		} else {
+			printf("Invalid command: %s\n", next->command);
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "SearchStats.h"
+#include "SolverOptions.h"
+#include <atomic>
+#include <mutex>
+
+class SolvedDatabase;
+struct SolveRequest;
+
+class BatchSolver {
+public:
+	BatchSolver(const SolverOptions& options, SolveRequest** requests, int count, SolvedDatabase* database);
+	void run();
+private:
+	SolverOptions options;
+	SolveRequest** requests;
+	int count;
+	SolvedDatabase* database;
+	int workerCount;
+	std::atomic<int> nextRequest;
+	std::mutex outputLock;
+	int nextToPrint;
+	SearchStats totalStats;
+	void work();
+	void finish(SolveRequest* request);
+};
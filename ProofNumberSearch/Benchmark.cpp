@@ -0,0 +1,122 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "Benchmark.h"
+#include "InputReader.h"
+#include "SolveRequest.h"
+#include <chrono>
+#include <cstdio>
+#include <string.h>
+
+#define POSITION_KEYWORD "POSITION"
+
+Benchmark::Benchmark(const SolverOptions& options) : options(options), table(options.tableSizeInBytes) {
+}
+
+bool Benchmark::run(const char* suitePath) {
+	if (options.databasePath != nullptr && !database.open(options.databasePath)) {
+		return false;
+	}
+	FILE* file = fopen(suitePath, "rb");
+	if (file == nullptr) {
+		fprintf(stderr, "Cannot open benchmark suite: %s\n", suitePath);
+		return false;
+	}
+	InputReader reader(file);
+	bool passed = true;
+	int count = 0;
+	char word[MAX_INPUT_LENGTH];
+	if (options.json) {
+		printf("[\n");
+	}
+	while (!reader.atEnd()) {
+		Sample sample;
+		char expected[MAX_INPUT_LENGTH];
+		if (!reader.readWord(word, MAX_INPUT_LENGTH) || !reader.readWord(sample.name, MAX_POSITION_NAME_LENGTH)
+			|| !reader.readWord(expected, MAX_INPUT_LENGTH)) {
+			break;
+		}
+		if (strcmp(word, POSITION_KEYWORD) != 0 || !parseResult(expected, sample.expected)) {
+			fprintf(stderr, "Invalid benchmark position header: %s %s %s\n", word, sample.name, expected);
+			passed = false;
+			break;
+		}
+		SolveRequest* request = SolveRequest::read(reader, options.algorithm);
+		if (request == nullptr) {
+			break;
+		}
+		if (!request->valid) {
+			fprintf(stderr, "Invalid command: %s\n", request->command);
+			delete request;
+			passed = false;
+			break;
+		}
+		measure(*request, sample);
+		print(sample, count++ == 0);
+		passed = passed && sample.result == sample.expected;
+		delete request;
+	}
+	if (options.json) {
+		printf("\n]\n");
+	}
+	fclose(file);
+	return passed && !reader.hasFailed();
+}
+
+void Benchmark::measure(SolveRequest& request, Sample& sample) {
+	SolverOptions requestOptions = options;
+	requestOptions.algorithm = request.algorithm;
+	table.clear();
+	NmkEngine engine(request.board, request.minToWin, request.player, table, requestOptions);
+	engine.setTimeLimit(options.timeLimit);
+	engine.setDatabase(options.databasePath != nullptr ? &database : nullptr);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	sample.result = engine.solve();
+	sample.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	sample.expandedNodes = engine.getExpandedNodes();
+	sample.peakArenaBytes = engine.getAllocationStats().peakBytesInUse;
+	sample.probes = table.getProbes();
+	sample.hits = table.getHits();
+}
+
+void Benchmark::print(const Sample& sample, bool first) const {
+	double nodesPerSecond = sample.seconds > 0 ? sample.expandedNodes / sample.seconds : 0;
+	double hitRate = sample.probes > 0 ? (double)sample.hits / sample.probes : 0;
+	std::size_t tableBytes = table.getCapacity() * sizeof(TranspositionTable::Entry);
+	bool passed = sample.result == sample.expected;
+	if (!options.json) {
+		printf("%-24s %-4s %-18s %9.3fs %12llu nodes %12.0f nodes/s %9.2f MB arena %6.2f%% tt hits\n", sample.name, passed ? "ok" : "FAIL",
+			getResultName(sample.result), sample.seconds, (unsigned long long)sample.expandedNodes, nodesPerSecond,
+			sample.peakArenaBytes / (1024.0 * 1024.0), hitRate * 100);
+		return;
+	}
+	printf("%s  {\"name\": \"%s\", \"expected\": \"%s\", \"result\": \"%s\", \"passed\": %s, \"seconds\": %.6f, \"expandedNodes\": %llu, "
+		"\"nodesPerSecond\": %.1f, \"peakArenaBytes\": %llu, \"tableBytes\": %llu, \"ttProbes\": %llu, \"ttHits\": %llu, \"ttHitRate\": %.6f}",
+		first ? "" : ",\n", sample.name, getResultName(sample.expected), getResultName(sample.result), passed ? "true" : "false", sample.seconds,
+		(unsigned long long)sample.expandedNodes, nodesPerSecond, (unsigned long long)sample.peakArenaBytes, (unsigned long long)tableBytes,
+		(unsigned long long)sample.probes, (unsigned long long)sample.hits, hitRate);
+}
+
+bool Benchmark::parseResult(const char* word, SolveResult& result) {
+	const SolveResult results[] = { SolveResult::FIRST_PLAYER_WINS, SolveResult::SECOND_PLAYER_WINS, SolveResult::BOTH_PLAYERS_TIE, SolveResult::UNKNOWN };
+	for (SolveResult candidate : results) {
+		if (strcmp(word, getResultName(candidate)) == 0) {
+			result = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* Benchmark::getResultName(SolveResult result) {
+	switch (result) {
+	case SolveResult::FIRST_PLAYER_WINS:
+		return "FIRST_PLAYER_WINS";
+	case SolveResult::SECOND_PLAYER_WINS:
+		return "SECOND_PLAYER_WINS";
+	case SolveResult::BOTH_PLAYERS_TIE:
+		return "BOTH_PLAYERS_TIE";
+	case SolveResult::UNKNOWN:
+		return "UNKNOWN";
+	}
+	return "UNKNOWN";
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Engine.h"
+#include "SolvedDatabase.h"
+#include "SolverOptions.h"
+#include "TranspositionTable.h"
+#include <cstdint>
+
+#define MAX_POSITION_NAME_LENGTH 64
+
+struct SolveRequest;
+
+class Benchmark {
+public:
+	explicit Benchmark(const SolverOptions& options);
+	bool run(const char* suitePath);
+private:
+	struct Sample {
+		char name[MAX_POSITION_NAME_LENGTH];
+		SolveResult expected;
+		SolveResult result;
+		double seconds;
+		uint64_t expandedNodes;
+		std::size_t peakArenaBytes;
+		std::size_t probes;
+		std::size_t hits;
+	};
+	SolverOptions options;
+	TranspositionTable table;
+	SolvedDatabase database;
+	void measure(SolveRequest& request, Sample& sample);
+	void print(const Sample& sample, bool first) const;
+	static bool parseResult(const char* word, SolveResult& result);
+	static const char* getResultName(SolveResult result);
+};
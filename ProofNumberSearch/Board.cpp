@@ -1,51 +1,113 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include "Board.h"
+#include "BitUtils.h"
+#include "InputReader.h"
+#include "ThreatSet.h"
+#include "Zobrist.h"
+#include <algorithm>
 #include <assert.h>
 #include <cstdio>
+#include <cstring>
 
-Board::Board(int width, int height) : width(width), height(height), numOfEmptyFields(height* width) {
-	board = new Player * [height];
-	for (int i = 0; i < height; i++) {
-		board[i] = new Player[width];
+#if defined(__AVX2__)
+#define BOARD_USE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOARD_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#define FIRST_PLANE 0
+#define SECOND_PLANE 1
+#define FIELDS_PLANE 2
+#define PLANE_COUNT 3
+#define SHIFT_SLACK_WORDS 8
+
+static const int LINE_DX[LINE_DIRECTIONS] = { 1, 0, 1, 1 };
+static const int LINE_DY[LINE_DIRECTIONS] = { 0, 1, 1, -1 };
+
+Board::Board(int width, int height) : width(width), height(height), stride(width + 1), numOfEmptyFields(height* width),
+	symmetryCount(width == height ? BOARD_SYMMETRIES : BOARD_SYMMETRIES / 2), lineLength(0), lineCounts(nullptr), cellWindows(nullptr), cellWindowStarts(nullptr), createdThreats(nullptr), createdThreatCount(0) {
+	clearHashes();
+	symmetricCells = new int[symmetryCount * width * height];
+	for (int symmetry = 0; symmetry < symmetryCount; symmetry++) {
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				symmetricCells[symmetry * width * height + y * width + x] = symmetricCell(symmetry, x, y);
+			}
+		}
+	}
+	wordCount = ((height + 2) * stride + 1) / 64 + 1;
+	planes = new uint64_t[PLANE_COUNT * wordCount];
+	memset(planes, 0, PLANE_COUNT * wordCount * sizeof(uint64_t));
+	uint64_t* fields = planes + FIELDS_PLANE * wordCount;
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			int index = fieldIndex(x, y);
+			fields[index >> 6] |= 1ULL << (index & 63);
+		}
 	}
 }
 
-Board::Board(const Board& other) : width(other.width), height(other.height), numOfEmptyFields(other.numOfEmptyFields) {
-	board = new Player * [height];
-	for (int i = 0; i < height; i++) {
-		board[i] = new Player[width];
-		for (int j = 0; j < width; j++) {
-			board[i][j] = other.board[i][j];
-		}
+Board::Board(const Board& other) : width(other.width), height(other.height), stride(other.stride), wordCount(other.wordCount),
+	numOfEmptyFields(other.numOfEmptyFields), symmetryCount(other.symmetryCount), lineLength(0), lineCounts(nullptr), cellWindows(nullptr), cellWindowStarts(nullptr), createdThreats(nullptr), createdThreatCount(0) {
+	planes = new uint64_t[PLANE_COUNT * wordCount];
+	memcpy(planes, other.planes, PLANE_COUNT * wordCount * sizeof(uint64_t));
+	memcpy(hashes, other.hashes, sizeof(hashes));
+	symmetricCells = new int[symmetryCount * width * height];
+	memcpy(symmetricCells, other.symmetricCells, symmetryCount * width * height * sizeof(int));
+	if (other.lineLength > 0) {
+		trackLines(other.lineLength);
 	}
 }
 
 Board::~Board() {
-	for (int i = 0; i < height; i++) {
-		delete[] board[i];
-	}
-	delete[] board;
+	delete[] planes;
+	delete[] symmetricCells;
+	delete[] lineCounts;
+	delete[] cellWindows;
+	delete[] cellWindowStarts;
+	delete[] createdThreats;
 }
 
 bool Board::withinBounds(int x, int y) const {
 	return x >= 0 && x < width&& y >= 0 && y < height;
 }
 
-const Player& Board::getPlayer(int x, int y) const {
+Player Board::getPlayer(int x, int y) const {
 	assert(withinBounds(x, y));
-	return board[y][x];
+	int index = fieldIndex(x, y);
+	if (testBit(planes + FIRST_PLANE * wordCount, index)) {
+		return Player::FIRST;
+	}
+	if (testBit(planes + SECOND_PLANE * wordCount, index)) {
+		return Player::SECOND;
+	}
+	return Player::NONE;
 }
 
 void Board::setPlayer(int x, int y, Player player) {
 	assert(withinBounds(x, y));
-	Player& p = board[y][x];
+	Player p = getPlayer(x, y);
 	if (p == Player::NONE && player != Player::NONE) {
 		numOfEmptyFields--;
 	} else if (p != Player::NONE && player == Player::NONE) {
 		numOfEmptyFields++;
 	}
-	board[y][x] = player;
+	int index = fieldIndex(x, y);
+	uint64_t mask = 1ULL << (index & 63);
+	createdThreatCount = 0;
+	if (p != Player::NONE) {
+		toggleStone(y * width + x, p);
+		planeFor(p)[index >> 6] &= ~mask;
+		updateLines(x, y, p, -1);
+	}
+	if (player != Player::NONE) {
+		toggleStone(y * width + x, player);
+		planeFor(player)[index >> 6] |= mask;
+		updateLines(x, y, player, 1);
+	}
 }
 
 int Board::getWidth() const {
@@ -60,24 +122,240 @@ bool Board::isFull() const {
 	return numOfEmptyFields <= 0;
 }
 
-void Board::read() {
+int Board::getEmptyFieldsCount() const {
+	return numOfEmptyFields;
+}
+
+uint64_t Board::getHash() const {
+	uint64_t canonical = hashes[0];
+	for (int symmetry = 1; symmetry < symmetryCount; symmetry++) {
+		canonical = std::min(canonical, hashes[symmetry]);
+	}
+	return canonical;
+}
+
+int Board::findSymmetries(int* symmetries) const {
+	int count = 0;
+	int cells = width * height;
+	for (int symmetry = 1; symmetry < symmetryCount; symmetry++) {
+		if (hashes[symmetry] != hashes[0]) {
+			continue;
+		}
+		const int* mapping = symmetricCells + symmetry * cells;
+		bool matches = true;
+		for (int cell = 0; cell < cells && matches; cell++) {
+			matches = getPlayer(cell % width, cell / width) == getPlayer(mapping[cell] % width, mapping[cell] / width);
+		}
+		if (matches) {
+			symmetries[count++] = symmetry;
+		}
+	}
+	return count;
+}
+
+bool Board::isCanonicalCell(int x, int y, const int* symmetries, int count) const {
+	int cell = y * width + x;
+	for (int i = 0; i < count; i++) {
+		if (symmetricCells[symmetries[i] * width * height + cell] < cell) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Player Board::findWinner(int k) const {
+	int first = firstLine(planes + FIRST_PLANE * wordCount, k);
+	int second = firstLine(planes + SECOND_PLANE * wordCount, k);
+	if (first == -1 && second == -1) {
+		return Player::NONE;
+	}
+	if (second == -1 || (first != -1 && first < second)) {
+		return Player::FIRST;
+	}
+	return Player::SECOND;
+}
+
+void Board::trackLines(int k) {
+	int cells = width * height;
+	delete[] lineCounts;
+	delete[] cellWindows;
+	delete[] cellWindowStarts;
+	delete[] createdThreats;
+	lineLength = k;
+	lineCounts = new uint16_t[(std::size_t)LINE_DIRECTIONS * cells * 2];
+	memset(lineCounts, 0, (std::size_t)LINE_DIRECTIONS * cells * 2 * sizeof(uint16_t));
+	cellWindowStarts = new std::size_t[(std::size_t)cells + 1];
+	memset(cellWindowStarts, 0, ((std::size_t)cells + 1) * sizeof(std::size_t));
+	forEachWindowCell(k, nullptr);
+	int mostWindows = 0;
+	for (int cell = 0; cell < cells; cell++) {
+		if ((int)cellWindowStarts[cell + 1] > mostWindows) {
+			mostWindows = (int)cellWindowStarts[cell + 1];
+		}
+		cellWindowStarts[cell + 1] += cellWindowStarts[cell];
+	}
+	cellWindows = new int[cellWindowStarts[cells]];
+	createdThreats = new int[mostWindows];
+	createdThreatCount = 0;
+	std::size_t* filled = new std::size_t[cells];
+	memcpy(filled, cellWindowStarts, cells * sizeof(std::size_t));
+	forEachWindowCell(k, filled);
+	delete[] filled;
+}
+
+void Board::forEachWindowCell(int k, std::size_t* filled) {
+	int cells = width * height;
+	for (int direction = 0; direction < LINE_DIRECTIONS; direction++) {
+		int dx = LINE_DX[direction];
+		int dy = LINE_DY[direction];
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (!withinBounds(x + (k - 1) * dx, y + (k - 1) * dy)) {
+					continue;
+				}
+				int window = direction * cells + y * width + x;
+				uint16_t* counts = lineCounts + 2 * window;
+				for (int i = 0; i < k; i++) {
+					int cell = (y + i * dy) * width + x + i * dx;
+					if (filled == nullptr) {
+						cellWindowStarts[cell + 1]++;
+						continue;
+					}
+					cellWindows[filled[cell]++] = window;
+					Player player = getPlayer(x + i * dx, y + i * dy);
+					if (player != Player::NONE) {
+						counts[player == Player::FIRST ? 0 : 1]++;
+					}
+				}
+			}
+		}
+	}
+}
+
+int Board::getLineLength() const {
+	return lineLength;
+}
+
+void Board::collectThreats(ThreatSet& threats) const {
+	assert(lineLength > 0);
+	int cells = width * height;
+	for (int direction = 0; direction < LINE_DIRECTIONS; direction++) {
+		int dx = LINE_DX[direction];
+		int dy = LINE_DY[direction];
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (!withinBounds(x + (lineLength - 1) * dx, y + (lineLength - 1) * dy)) {
+					continue;
+				}
+				const uint16_t* counts = lineCounts + 2 * (direction * cells + y * width + x);
+				for (int p = 0; p < 2; p++) {
+					if (counts[p] == lineLength - 1 && counts[1 - p] == 0) {
+						int cell = findEmptyInWindow(x, y, dx, dy);
+						threats.add(p == 0 ? Player::FIRST : Player::SECOND, cell % width, cell / width);
+					}
+				}
+			}
+		}
+	}
+}
+
+void Board::collectThreatsThrough(int x, int y, const Player& player, ThreatSet& threats) const {
+	assert(lineLength > 0);
+	int cells = width * height;
+	int cell = y * width + x;
+	int own = player == Player::FIRST ? 0 : 1;
+	const int* windows = cellWindows + cellWindowStarts[cell];
+	int windowCount = (int)(cellWindowStarts[cell + 1] - cellWindowStarts[cell]);
+	for (int i = 0; i < windowCount; i++) {
+		const uint16_t* counts = lineCounts + 2 * windows[i];
+		if (counts[own] == lineLength - 1 && counts[1 - own] == 0) {
+			int direction = windows[i] / cells;
+			int start = windows[i] % cells;
+			int empty = findEmptyInWindow(start % width, start / width, LINE_DX[direction], LINE_DY[direction]);
+			threats.add(player, empty % width, empty / width);
+		}
+	}
+}
+
+void Board::collectThreatMoves(const Player& player, ThreatSet& moves) const {
+	assert(lineLength > 0);
+	int cells = width * height;
+	int own = player == Player::FIRST ? 0 : 1;
+	for (int direction = 0; direction < LINE_DIRECTIONS; direction++) {
+		int dx = LINE_DX[direction];
+		int dy = LINE_DY[direction];
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				if (!withinBounds(x + (lineLength - 1) * dx, y + (lineLength - 1) * dy)) {
+					continue;
+				}
+				const uint16_t* counts = lineCounts + 2 * (direction * cells + y * width + x);
+				if (counts[own] + 2 != lineLength || counts[1 - own] != 0) {
+					continue;
+				}
+				for (int i = 0; i < lineLength; i++) {
+					if (getPlayer(x + i * dx, y + i * dy) == Player::NONE) {
+						moves.add(player, x + i * dx, y + i * dy);
+					}
+				}
+			}
+		}
+	}
+}
+
+int Board::getCreatedThreatCount() const {
+	return createdThreatCount;
+}
+
+int Board::getCreatedThreat(int i) const {
+	return createdThreats[i];
+}
+
+int Board::scoreCell(int x, int y, const Player& player) const {
+	assert(lineLength > 0);
+	int own = player == Player::FIRST ? 0 : 1;
+	int cell = y * width + x;
+	const int* windows = cellWindows + cellWindowStarts[cell];
+	int windowCount = (int)(cellWindowStarts[cell + 1] - cellWindowStarts[cell]);
+	int score = 0;
+	for (int i = 0; i < windowCount; i++) {
+		const uint16_t* counts = lineCounts + 2 * windows[i];
+		if (counts[1 - own] == 0) {
+			score += (counts[own] + 1) * (counts[own] + 1);
+		} else if (counts[own] == 0) {
+			score += counts[1 - own] * counts[1 - own];
+		}
+	}
+	return score;
+}
+
+bool Board::read(InputReader& reader) {
 	numOfEmptyFields = 0;
+	clearHashes();
+	memset(planes, 0, 2 * wordCount * sizeof(uint64_t));
 	int input;
 	for (int i = 0; i < height; i++) {
 		for (int j = 0; j < width; j++) {
-			scanf("%d", &input);
-			board[i][j] = Player(input);
-			if (board[i][j] == Player::NONE) {
+			if (!reader.readInt(input, 0, 2)) {
+				return false;
+			}
+			Player player = Player(input);
+			if (player == Player::NONE) {
 				numOfEmptyFields++;
+			} else {
+				int index = fieldIndex(j, i);
+				planeFor(player)[index >> 6] |= 1ULL << (index & 63);
+				toggleStone(i * width + j, player);
 			}
 		}
 	}
+	return true;
 }
 
 void Board::write() const {
 	for (int i = 0; i < height; i++) {
 		for (int j = 0; j < width; j++) {
-			printf("%d ", board[i][j].valueAsInt());
+			printf("%d ", getPlayer(j, i).valueAsInt());
 		}
 		printf("\n");
 	}
@@ -90,3 +368,138 @@ void Board::makeAMove(Move& move) {
 void Board::undoMove(Move& move) {
 	setPlayer(move.x, move.y, Player::NONE);
 }
+
+int Board::fieldIndex(int x, int y) const {
+	return (y + 1) * stride + x + 1;
+}
+
+int Board::symmetricCell(int symmetry, int x, int y) const {
+	int flippedX = width - 1 - x;
+	int flippedY = height - 1 - y;
+	switch (symmetry) {
+	case 1:
+		return y * width + flippedX;
+	case 2:
+		return flippedY * width + x;
+	case 3:
+		return flippedY * width + flippedX;
+	case 4:
+		return x * width + y;
+	case 5:
+		return flippedX * width + y;
+	case 6:
+		return x * width + flippedY;
+	case 7:
+		return flippedX * width + flippedY;
+	}
+	return y * width + x;
+}
+
+void Board::toggleStone(int cell, const Player& player) {
+	for (int symmetry = 0; symmetry < symmetryCount; symmetry++) {
+		hashes[symmetry] ^= Zobrist::cellKey(symmetricCells[symmetry * width * height + cell], player);
+	}
+}
+
+void Board::updateLines(int x, int y, const Player& player, int delta) {
+	if (lineLength == 0) {
+		return;
+	}
+	int cells = width * height;
+	int own = player == Player::FIRST ? 0 : 1;
+	int cell = y * width + x;
+	const int* windows = cellWindows + cellWindowStarts[cell];
+	int windowCount = (int)(cellWindowStarts[cell + 1] - cellWindowStarts[cell]);
+	for (int i = 0; i < windowCount; i++) {
+		uint16_t* counts = lineCounts + 2 * windows[i];
+		counts[own] += delta;
+		if (delta > 0 && counts[own] == lineLength - 1 && counts[1 - own] == 0) {
+			int direction = windows[i] / cells;
+			int start = windows[i] % cells;
+			createdThreats[createdThreatCount++] = findEmptyInWindow(start % width, start / width, LINE_DX[direction], LINE_DY[direction]);
+		}
+	}
+}
+
+int Board::findEmptyInWindow(int x, int y, int dx, int dy) const {
+	for (int i = 0; i < lineLength; i++) {
+		if (getPlayer(x + i * dx, y + i * dy) == Player::NONE) {
+			return (y + i * dy) * width + x + i * dx;
+		}
+	}
+	assert(false);
+	return -1;
+}
+
+void Board::clearHashes() {
+	for (int symmetry = 0; symmetry < BOARD_SYMMETRIES; symmetry++) {
+		hashes[symmetry] = 0;
+	}
+}
+
+uint64_t* Board::planeFor(const Player& player) const {
+	assert(player != Player::NONE);
+	return planes + (player == Player::FIRST ? FIRST_PLANE : SECOND_PLANE) * wordCount;
+}
+
+bool Board::testBit(const uint64_t* plane, int index) const {
+	return (plane[index >> 6] >> (index & 63)) & 1;
+}
+
+int Board::firstLine(const uint64_t* plane, int k) const {
+	const int shifts[] = { 1, stride, stride + 1, stride - 1 };
+	int scratchWords = wordCount + (stride + 1) / 64 + SHIFT_SLACK_WORDS;
+	uint64_t* scratch = new uint64_t[scratchWords];
+	int result = -1;
+	for (int shift : shifts) {
+		memset(scratch, 0, scratchWords * sizeof(uint64_t));
+		memcpy(scratch, plane, wordCount * sizeof(uint64_t));
+		for (int i = 1; i < k; i++) {
+			andShiftedRight(scratch, wordCount, shift);
+		}
+		for (int w = 0; w < wordCount; w++) {
+			if (scratch[w] != 0) {
+				int index = w * 64 + countTrailingZeros(scratch[w]);
+				if (result == -1 || index < result) {
+					result = index;
+				}
+				break;
+			}
+		}
+	}
+	delete[] scratch;
+	return result;
+}
+
+void Board::andShiftedRight(uint64_t* plane, int words, int shift) {
+	int wordShift = shift >> 6;
+	int bitShift = shift & 63;
+	int w = 0;
+#if defined(BOARD_USE_AVX2)
+	__m128i right = _mm_cvtsi32_si128(bitShift);
+	__m128i left = _mm_cvtsi32_si128(64 - bitShift);
+	for (; w + 4 <= words; w += 4) {
+		__m256i low = _mm256_loadu_si256((const __m256i*)(plane + w + wordShift));
+		__m256i high = _mm256_loadu_si256((const __m256i*)(plane + w + wordShift + 1));
+		__m256i shifted = _mm256_or_si256(_mm256_srl_epi64(low, right), _mm256_sll_epi64(high, left));
+		__m256i current = _mm256_loadu_si256((const __m256i*)(plane + w));
+		_mm256_storeu_si256((__m256i*)(plane + w), _mm256_and_si256(current, shifted));
+	}
+#elif defined(BOARD_USE_SSE2)
+	__m128i right = _mm_cvtsi32_si128(bitShift);
+	__m128i left = _mm_cvtsi32_si128(64 - bitShift);
+	for (; w + 2 <= words; w += 2) {
+		__m128i low = _mm_loadu_si128((const __m128i*)(plane + w + wordShift));
+		__m128i high = _mm_loadu_si128((const __m128i*)(plane + w + wordShift + 1));
+		__m128i shifted = _mm_or_si128(_mm_srl_epi64(low, right), _mm_sll_epi64(high, left));
+		__m128i current = _mm_loadu_si128((const __m128i*)(plane + w));
+		_mm_storeu_si128((__m128i*)(plane + w), _mm_and_si128(current, shifted));
+	}
+#endif
+	for (; w < words; w++) {
+		uint64_t low = plane[w + wordShift];
+		uint64_t high = plane[w + wordShift + 1];
+		uint64_t shifted = bitShift == 0 ? low : (low >> bitShift) | (high << (64 - bitShift));
+		plane[w] &= shifted;
+	}
+}
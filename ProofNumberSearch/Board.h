@@ -1,9 +1,16 @@
 #pragma once
 
+#include "Move.h"
 #include "Player.h"
-#include "LinkedMoveList.h"
+#include <cstddef>
+#include <cstdint>
 
+#define BOARD_SYMMETRIES 8
+#define LINE_DIRECTIONS 4
+
+class InputReader;
 class Player;
+class ThreatSet;
 struct Move;
 
 class Board {
@@ -11,20 +18,55 @@ public:
 	Board(int width, int height);
 	Board(const Board& other);
 	~Board();
-	const Player& getPlayer(int x, int y) const;
+	Player getPlayer(int x, int y) const;
 	void setPlayer(int x, int y, Player player);
 	int getWidth() const;
 	int getHeight() const;
 	bool withinBounds(int x, int y) const;
 	bool isFull() const;
+	int getEmptyFieldsCount() const;
+	uint64_t getHash() const;
+	int findSymmetries(int* symmetries) const;
+	bool isCanonicalCell(int x, int y, const int* symmetries, int count) const;
+	Player findWinner(int k) const;
+	void trackLines(int k);
+	int getLineLength() const;
+	void collectThreats(ThreatSet& threats) const;
+	void collectThreatsThrough(int x, int y, const Player& player, ThreatSet& threats) const;
+	void collectThreatMoves(const Player& player, ThreatSet& moves) const;
+	int getCreatedThreatCount() const;
+	int getCreatedThreat(int i) const;
+	int scoreCell(int x, int y, const Player& player) const;
 	void makeAMove(Move& move);
 	void undoMove(Move& move);
 
-	void read();
+	bool read(InputReader& reader);
 	void write() const;
 private:
-	Player** board;
+	uint64_t* planes;
 	int width;
 	int height;
+	int stride;
+	int wordCount;
 	int numOfEmptyFields;
+	uint64_t hashes[BOARD_SYMMETRIES];
+	int symmetryCount;
+	int* symmetricCells;
+	int lineLength;
+	uint16_t* lineCounts;
+	int* cellWindows;
+	std::size_t* cellWindowStarts;
+	int* createdThreats;
+	int createdThreatCount;
+	int fieldIndex(int x, int y) const;
+	int symmetricCell(int symmetry, int x, int y) const;
+	void toggleStone(int cell, const Player& player);
+	void clearHashes();
+	void forEachWindowCell(int k, std::size_t* filled);
+	void updateLines(int x, int y, const Player& player, int delta);
+	int findEmptyInWindow(int x, int y, int dx, int dy) const;
+	uint64_t* planeFor(const Player& player) const;
+	bool testBit(const uint64_t* plane, int index) const;
+	int firstLine(const uint64_t* plane, int k) const;
+	static void andShiftedRight(uint64_t* plane, int words, int shift);
 };
@@ -1,75 +1,571 @@
 #include "Engine.h"
+#include "SolvedDatabase.h"
+#include "Zobrist.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 
-NmkEngine::NmkEngine(Board& board, int k, Player player) : board(board), minToWin(k), player(player) {
+NmkEngine::NmkEngine(Board& board, int k, Player player, TranspositionTable& table, const SolverOptions& options) : board(board), minToWin(k), player(player), table(table),
+	options(options), database(nullptr), goal(Goal::WINNING), configKey(Zobrist::configKey(board.getWidth(), board.getHeight(), k, player)), searchKey(configKey), iterations(0), expandedNodes(0),
+	workerId(0), stopFlag(nullptr), hasDeadline(false), timeLimit(0), nodeLimit(options.nodeLimit), memoryLimit(options.memoryLimit), nodesAtStart(0),
+	exhausted(false), stopChecks(0), pausedRoot(nullptr), winningRefuted(false), progressGoal(Goal::WINNING), progressProof(0), progressDisproof(0), bestX(UNKNOWN_MOVE), bestY(UNKNOWN_MOVE),
+	reportMove(false), pvLength(0) {
+	if (board.getLineLength() != k) {
+		board.trackLines(k);
+	}
 }
 
-void NmkEngine::solve() {
-	for (int y = 0; y < board.getHeight(); y++) {
-		for (int x = 0; x < board.getWidth(); x++) {
-			if (Player::NONE == board.getPlayer(x, y)) {
-				continue;
-			}
-			if (isWinning(x, y)) {
-				printf(board.getPlayer(x, y) == Player::FIRST ? MESSAGE_P1 : MESSAGE_P2);
-				return;
-			}
-		}
+SolveResult NmkEngine::solve() {
+	Player winner = board.findWinner(minToWin);
+	if (winner != Player::NONE) {
+		return winner == Player::FIRST ? SolveResult::FIRST_PLAYER_WINS : SolveResult::SECOND_PLAYER_WINS;
+	}
+	uint64_t key = configKey ^ board.getHash();
+	SolveResult result;
+	if (!reportMove && database != nullptr && database->lookup(key, result)) {
+		return result;
+	}
+	result = searchResult();
+	if (database != nullptr) {
+		database->record(key, result, (uint32_t)std::min<uint64_t>(expandedNodes, UINT32_MAX));
+	}
+	if (reportMove) {
+		findPrincipalVariation(result);
+	}
+	return result;
+}
+
+SolveResult NmkEngine::solveWithRetries(int retries) {
+	SolveResult result = solve();
+	for (int attempt = 0; attempt < retries && result == SolveResult::UNKNOWN && exhausted; attempt++) {
+		setNodeLimit(nodeLimit * RETRY_BUDGET_GROWTH);
+		setMemoryLimit(memoryLimit * RETRY_BUDGET_GROWTH);
+		setTimeLimit(timeLimit * RETRY_BUDGET_GROWTH);
+		result = solve();
+	}
+	return result;
+}
+
+SolveResult NmkEngine::searchResult() {
+	exhausted = false;
+	nodesAtStart = expandedNodes;
+	int result = searchWithGoals();
+	if (exhausted) {
+		return SolveResult::UNKNOWN;
 	}
-	LinkedMoveList* threatsAtStart = new LinkedMoveList();
-	fillThreatsAtStart(*threatsAtStart);
-	Move move = Move(player.getOpponent(), UNKNOWN_MOVE, UNKNOWN_MOVE);
-	Node* root = new Node(nullptr, move, Type::OR, threatsAtStart);
-	int result = proofNumberSearch(root);
-	delete root;
 	if (result == TIE) {
-		printf(MESSAGE_TIE);
+		return SolveResult::BOTH_PLAYERS_TIE;
+	}
+	return getWinningPlayer(result) == Player::FIRST ? SolveResult::FIRST_PLAYER_WINS : SolveResult::SECOND_PLAYER_WINS;
+}
+
+void NmkEngine::writeResult(SolveResult result, char* buffer, int capacity) const {
+	if (result == SolveResult::UNKNOWN && exhausted) {
+		snprintf(buffer, capacity, "UNKNOWN %s proof %d disproof %d best %d %d\n", progressGoal == Goal::WINNING ? "WINNING" : "NOT_LOSING",
+			progressProof, progressDisproof, bestX, bestY);
 		return;
 	}
-	printf(getWinningPlayer(result) == Player::FIRST ? MESSAGE_P1 : MESSAGE_P2);
+	const char* message = getResultMessage(result);
+	if (pvLength == 0) {
+		snprintf(buffer, capacity, "%s", message);
+		return;
+	}
+	int length = snprintf(buffer, capacity, "%.*s move %d %d pv", (int)strlen(message) - 1, message, pvMoves[0], pvMoves[1]);
+	for (int i = 0; i < pvLength && length < capacity; i++) {
+		length += snprintf(buffer + length, capacity - length, " %d %d", pvMoves[2 * i], pvMoves[2 * i + 1]);
+	}
+	if (length < capacity) {
+		snprintf(buffer + length, capacity - length, "\n");
+	}
 }
 
-int NmkEngine::proofNumberSearch(Node* root) {
-	evaluate(root);
-	setProofAndDisproofNumbers(root);
+const char* NmkEngine::getResultMessage(SolveResult result) {
+	switch (result) {
+	case SolveResult::FIRST_PLAYER_WINS:
+		return MESSAGE_P1;
+	case SolveResult::SECOND_PLAYER_WINS:
+		return MESSAGE_P2;
+	case SolveResult::BOTH_PLAYERS_TIE:
+		return MESSAGE_TIE;
+	case SolveResult::UNKNOWN:
+		return MESSAGE_UNKNOWN;
+	}
+	return MESSAGE_UNKNOWN;
+}
+
+void NmkEngine::setTimeLimit(double seconds) {
+	timeLimit = seconds;
+	hasDeadline = seconds > 0;
+	deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void NmkEngine::setDatabase(SolvedDatabase* solvedDatabase) {
+	database = solvedDatabase;
+}
+
+void NmkEngine::setNodeLimit(uint64_t nodes) {
+	nodeLimit = nodes;
+}
+
+void NmkEngine::setMemoryLimit(std::size_t bytes) {
+	memoryLimit = bytes;
+}
+
+void NmkEngine::setReportMove(bool report) {
+	reportMove = report;
+}
+
+Arena::Stats NmkEngine::getAllocationStats() const {
+	Arena::Stats stats = arena.getStats();
+	Arena::Stats spare = spareArena.getStats();
+	stats.allocations += spare.allocations;
+	stats.peakBytesInUse = std::max(stats.peakBytesInUse, spare.peakBytesInUse);
+	stats.bytesReserved += spare.bytesReserved;
+	stats.blocks += spare.blocks;
+	return stats;
+}
+
+uint64_t NmkEngine::getExpandedNodes() const {
+	return expandedNodes;
+}
+
+const SearchStats& NmkEngine::getStats() const {
+	return stats;
+}
+
+NmkEngine::Node* NmkEngine::createRoot() {
+	ThreatSet threatsAtStart(board.getWidth(), board.getHeight());
+	fillThreatsAtStart(threatsAtStart);
+	STATS(stats.rootEmptyFields = board.getEmptyFieldsCount());
+	STATS(stats.growTree(1));
+	Move move = Move(player.getOpponent(), UNKNOWN_MOVE, UNKNOWN_MOVE);
+	Node* root = arena.create<Node>(nullptr, move, Type::OR);
+	root->threats = arena.create<ThreatSet>(threatsAtStart, arena);
+	return root;
+}
+
+int NmkEngine::searchWithGoals() {
+	if (!winningRefuted) {
+		if (search(Goal::WINNING) == Value::PROVEN) {
+			return WIN;
+		}
+		if (exhausted) {
+			return LOSS;
+		}
+		winningRefuted = true;
+	}
+	return search(Goal::NOT_LOSING) == Value::PROVEN ? TIE : LOSS;
+}
+
+NmkEngine::Value NmkEngine::search(Goal searchGoal) {
+	if (options.threads > 1 && options.algorithm == Algorithm::DFPN) {
+		return parallelDepthFirstSearch(searchGoal);
+	}
+	return options.algorithm == Algorithm::DFPN ? depthFirstSearch(searchGoal) : proofNumberSearch(searchGoal);
+}
+
+NmkEngine::Value NmkEngine::proofNumberSearch(Goal searchGoal) {
+	setGoal(searchGoal);
+	Node* root = pausedRoot;
+	pausedRoot = nullptr;
+	if (root == nullptr) {
+		root = createRoot();
+		evaluate(root);
+		setProofAndDisproofNumbers(root);
+	}
 	Node* currentNode = root;
-	while (root->proof != 0 && root->disproof != 0) {
+	while (root->proof != 0 && root->disproof != 0 && !isStopped()) {
+		if (memoryLimit > 0 && arena.getStats().bytesInUse >= memoryLimit / 2) {
+			for (; currentNode != root; currentNode = currentNode->parent) {
+				board.undoMove(currentNode->moveMade);
+			}
+			root = collectGarbage(root);
+			currentNode = root;
+		}
+		iterations++;
 		Node* mostProvingNode = selectMostProvingNode(currentNode);
 		expandNode(mostProvingNode);
 		currentNode = updateAncestors(mostProvingNode, root);
 	}
+	for (; currentNode != root; currentNode = currentNode->parent) {
+		board.undoMove(currentNode->moveMade);
+	}
+	Value outcome = Value::UNKNOWN;
 	if (root->proof == 0) {
-		return WIN;
+		outcome = Value::PROVEN;
+	} else if (root->disproof == 0) {
+		outcome = Value::DISPROVEN;
+	}
+	if (outcome == Value::UNKNOWN && exhausted) {
+		recordProgress(root);
+		pausedRoot = root;
+		return outcome;
+	}
+	STATS(stats.treeSize = 0);
+	arena.reset();
+	return outcome;
+}
+
+NmkEngine::Value NmkEngine::depthFirstSearch(Goal searchGoal) {
+	setGoal(searchGoal);
+	Node* root = createRoot();
+	evaluate(root);
+	setProofAndDisproofNumbers(root);
+	if (root->proof != 0 && root->disproof != 0) {
+		multipleIterativeDeepening(root, INFINTE, INFINTE);
+	}
+	Value outcome = Value::UNKNOWN;
+	if (root->proof == 0) {
+		outcome = Value::PROVEN;
+	} else if (root->disproof == 0) {
+		outcome = Value::DISPROVEN;
+	}
+	if (outcome == Value::UNKNOWN && exhausted) {
+		recordProgress(root);
 	}
-	bool tie = root->value != Value::UNKNOWN ? root->value == Value::DRAWN : detectTie(root);
-	return tie ? TIE : LOSS;
+	STATS(stats.treeSize = 0);
+	arena.reset();
+	return outcome;
+}
+
+NmkEngine::Value NmkEngine::parallelDepthFirstSearch(Goal searchGoal) {
+	std::atomic<bool> stop(false);
+	std::atomic<int> outcome((int)Value::UNKNOWN);
+	int helperCount = options.threads - 1;
+	Board** boards = new Board * [helperCount];
+	std::thread* helpers = new std::thread[helperCount];
+	table.setShared(true);
+	for (int i = 0; i < helperCount; i++) {
+		boards[i] = new Board(board);
+		helpers[i] = std::thread(&NmkEngine::runHelper, this, i + 1, boards[i], searchGoal, &stop, &outcome);
+	}
+	stopFlag = &stop;
+	reportOutcome(depthFirstSearch(searchGoal), &stop, &outcome);
+	stopFlag = nullptr;
+	stop.store(true);
+	for (int i = 0; i < helperCount; i++) {
+		helpers[i].join();
+		delete boards[i];
+	}
+	table.setShared(false);
+	delete[] helpers;
+	delete[] boards;
+	return (Value)outcome.load();
+}
+
+void NmkEngine::runHelper(int id, Board* localBoard, Goal searchGoal, std::atomic<bool>* stop, std::atomic<int>* outcome) const {
+	NmkEngine helper(*localBoard, minToWin, player, table, options);
+	helper.workerId = id;
+	helper.stopFlag = stop;
+	reportOutcome(helper.depthFirstSearch(searchGoal), stop, outcome);
+}
+
+void NmkEngine::reportOutcome(Value outcome, std::atomic<bool>* stop, std::atomic<int>* sharedOutcome) {
+	if (outcome == Value::UNKNOWN) {
+		return;
+	}
+	int expected = (int)Value::UNKNOWN;
+	sharedOutcome->compare_exchange_strong(expected, (int)outcome);
+	stop->store(true);
+}
+
+bool NmkEngine::isStopped() {
+	if (++stopChecks % DEADLINE_CHECK_INTERVAL == 0) {
+		if (hasDeadline && std::chrono::steady_clock::now() >= deadline) {
+			exhausted = true;
+		}
+		if (memoryLimit > 0 && arena.getStats().bytesInUse >= memoryLimit) {
+			exhausted = true;
+		}
+	}
+	if (nodeLimit > 0 && expandedNodes - nodesAtStart >= nodeLimit) {
+		exhausted = true;
+	}
+	return exhausted || (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed));
+}
+
+void NmkEngine::recordProgress(Node* root) {
+	if (root->childrenCount == 0) {
+		expandNode(root);
+		setProofAndDisproofNumbers(root);
+	}
+	progressGoal = goal;
+	progressProof = root->proof;
+	progressDisproof = root->disproof;
+	Node* best = nullptr;
+	for (int i = 0; i < root->childrenCount; i++) {
+		if (best == nullptr || root->children[i].proof < best->proof) {
+			best = &root->children[i];
+		}
+	}
+	if (best != nullptr) {
+		bestX = best->moveMade.x;
+		bestY = best->moveMade.y;
+	}
+}
+
+void NmkEngine::findPrincipalVariation(SolveResult result) {
+	pvLength = 0;
+	if (result == SolveResult::UNKNOWN) {
+		return;
+	}
+	bool won = result != SolveResult::BOTH_PLAYERS_TIE && (result == SolveResult::FIRST_PLAYER_WINS) == (player == Player::FIRST);
+	setGoal(won ? Goal::WINNING : Goal::NOT_LOSING);
+	Player mover = player;
+	while (pvLength < MAX_PV_LENGTH && !board.isFull() && board.findWinner(minToWin) == Player::NONE) {
+		int cell = findDecisiveMove(mover, result == SolveResult::BOTH_PLAYERS_TIE || won);
+		if (cell == -1) {
+			break;
+		}
+		Move move(mover, cell % board.getWidth(), cell / board.getWidth());
+		board.makeAMove(move);
+		pvMoves[2 * pvLength] = move.x;
+		pvMoves[2 * pvLength + 1] = move.y;
+		pvLength++;
+		mover = mover.getOpponent();
+	}
+	for (int i = pvLength - 1; i >= 0; i--) {
+		mover = mover.getOpponent();
+		Move move(mover, pvMoves[2 * i], pvMoves[2 * i + 1]);
+		board.undoMove(move);
+	}
+}
+
+int NmkEngine::findDecisiveMove(const Player& mover, bool proven) {
+	int width = board.getWidth();
+	ThreatSet threats(width, board.getHeight());
+	fillThreatsAtStart(threats);
+	if (threats.sizeByPlayer(mover) > 0) {
+		return threats.findNext(mover, 0);
+	}
+	Move lastMove(mover.getOpponent(), UNKNOWN_MOVE, UNKNOWN_MOVE);
+	Node* node = arena.create<Node>(nullptr, lastMove, mover == player ? Type::OR : Type::AND);
+	node->threats = &threats;
+	generateChildren(node);
+	int cell = -1;
+	for (int i = 0; i < node->childrenCount && cell == -1; i++) {
+		Node* child = &node->children[i];
+		board.makeAMove(child->moveMade);
+		evaluate(child);
+		setProofAndDisproofNumbers(child);
+		board.undoMove(child->moveMade);
+		if (proven ? child->proof == 0 : child->disproof == 0) {
+			cell = child->moveMade.y * width + child->moveMade.x;
+		}
+	}
+	int budget = THREAT_SEARCH_BUDGET;
+	if (cell == -1 && options.threatSearch && threats.sizeByPlayer(mover.getOpponent()) == 0) {
+		hasThreatSpaceWin(mover, threats, budget, &cell);
+	}
+	STATS(stats.treeSize = 0);
+	arena.reset();
+	return cell;
+}
+
+void NmkEngine::multipleIterativeDeepening(Node* node, int proofThreshold, int disproofThreshold) {
+	uint32_t iterationsAtStart = iterations++;
+	materializeThreats(node);
+	Arena::Marker subtree = arena.mark();
+	expandNode(node);
+	setProofAndDisproofNumbers(node);
+	while (node->proof < proofThreshold && node->disproof < disproofThreshold && !isStopped()) {
+		int childProofThreshold;
+		int childDisproofThreshold;
+		Node* child = selectChild(node, proofThreshold, disproofThreshold, childProofThreshold, childDisproofThreshold, stopFlag != nullptr);
+		board.makeAMove(child->moveMade);
+		if (stopFlag != nullptr) {
+			table.enter(child->key);
+			multipleIterativeDeepening(child, childProofThreshold, childDisproofThreshold);
+			table.leave(child->key);
+			refreshChildren(node);
+			board.undoMove(child->moveMade);
+			setProofAndDisproofNumbers(node);
+		} else {
+			int oldProof = child->proof;
+			int oldDisproof = child->disproof;
+			multipleIterativeDeepening(child, childProofThreshold, childDisproofThreshold);
+			board.undoMove(child->moveMade);
+			applyChildChange(node, child, oldProof, oldDisproof);
+		}
+	}
+	table.store(positionKey(node), node->proof, node->disproof, node->value, iterations - iterationsAtStart);
+	STATS(stats.shrinkTree(node->childrenCount));
+	node->releaseChildren();
+	arena.release(subtree);
+}
+
+NmkEngine::Node* NmkEngine::selectChild(Node* node, int proofThreshold, int disproofThreshold, int& childProofThreshold, int& childDisproofThreshold, bool penalize) const {
+	Node* best = nullptr;
+	int bestNumber = INFINTE;
+	int second = INFINTE;
+	int offset = workerId % node->childrenCount;
+	for (int i = 0; i < node->childrenCount; i++) {
+		Node* child = &node->children[(i + offset) % node->childrenCount];
+		int number = selectionNumber(node, child, penalize);
+		if (best == nullptr || number < bestNumber) {
+			if (best != nullptr) {
+				second = bestNumber;
+			}
+			best = child;
+			bestNumber = number;
+		} else if (number < second) {
+			second = number;
+		}
+	}
+	int penalty = bestNumber - (node->type == Type::OR ? best->proof : best->disproof);
+	int secondThreshold = second == INFINTE ? INFINTE : widenThreshold(second) - penalty;
+	if (node->type == Type::OR) {
+		childProofThreshold = std::min(proofThreshold, secondThreshold);
+		childDisproofThreshold = disproofThreshold - node->disproof + best->disproof;
+	} else {
+		childProofThreshold = proofThreshold - node->proof + best->proof;
+		childDisproofThreshold = std::min(disproofThreshold, secondThreshold);
+	}
+	if (penalize && (childProofThreshold <= best->proof || childDisproofThreshold <= best->disproof)) {
+		return selectChild(node, proofThreshold, disproofThreshold, childProofThreshold, childDisproofThreshold, false);
+	}
+	return best;
+}
+
+int NmkEngine::widenThreshold(int second) const {
+	double widened = std::ceil(second * (1 + options.epsilon));
+	return widened >= INFINTE ? INFINTE : std::max(second + 1, (int)widened);
+}
+
+int NmkEngine::selectionNumber(const Node* node, const Node* child, bool penalize) const {
+	int number = node->type == Type::OR ? child->proof : child->disproof;
+	if (!penalize || number == 0 || number == INFINTE) {
+		return number;
+	}
+	int penalty = VIRTUAL_PROOF_PENALTY * table.getBusy(child->key);
+	return number > INFINTE - penalty ? INFINTE : number + penalty;
+}
+
+void NmkEngine::refreshChildren(Node* node) {
+	TranspositionTable::Entry entry;
+	for (int i = 0; i < node->childrenCount; i++) {
+		Node* child = &node->children[i];
+		if (child->value == Value::UNKNOWN && child->proof != 0 && child->disproof != 0 && table.lookup(child->key, entry)) {
+			child->proof = entry.proof;
+			child->disproof = entry.disproof;
+		}
+	}
+}
+
+void NmkEngine::setGoal(Goal searchGoal) {
+	goal = searchGoal;
+	searchKey = configKey ^ Zobrist::goalKey((int)searchGoal);
 }
 
 void NmkEngine::evaluate(Node* root) const {
+	STATS_TIMER(evaluateSeconds);
+	STATS(stats.nodesEvaluated++);
+	uint64_t key = positionKey(root);
+	root->key = key;
+	TranspositionTable::Entry entry;
+	bool found = table.lookup(key, entry);
+	if (found && entry.value != Value::UNKNOWN) {
+		root->value = entry.value;
+		return;
+	}
+	ThreatSet threats(root->parent != nullptr ? *root->parent->threats : *root->threats);
+	evaluatePosition(root, threats);
+	STATS(stats.recordThreats(threats.sizeByPlayer(Player::FIRST) + threats.sizeByPlayer(Player::SECOND)));
+	if (root->value != Value::UNKNOWN) {
+		setProofAndDisproofNumbers(root);
+		table.store(key, root->proof, root->disproof, root->value, 1);
+	} else if (found) {
+		root->proof = entry.proof;
+		root->disproof = entry.disproof;
+	}
+}
+
+void NmkEngine::evaluatePosition(Node* root, ThreatSet& threats) const {
 	Player playerToMove = root->moveMade.player.getOpponent();
-	if (moveWasWinning(root->moveMade, *root->threats)) {
+	if (moveWasWinning(root->moveMade, threats)) {
 		setNodeValue(root, root->moveMade.player);
 		return;
 	}
-	removeBlockedThreats(root->moveMade, *root->threats);
+	removeBlockedThreats(root->moveMade, threats);
 	if (board.isFull()) {
 		root->value = Value::DRAWN;
 		return;
 	}
-	if (root->threats->sizeByPlayer(playerToMove) >= 1) {
+	if (threats.sizeByPlayer(playerToMove) >= 1) {
 		setNodeValue(root, playerToMove);
 		return;
 	}
-	addThreats(root->moveMade, *root->threats);
-	if (root->threats->sizeByPlayer(root->moveMade.player) >= 2) {
+	addThreats(root->moveMade, threats);
+	if (threats.sizeByPlayer(root->moveMade.player) >= 2) {
 		setNodeValue(root, root->moveMade.player);
 		return;
 	}
+	int budget = THREAT_SEARCH_BUDGET;
+	if (options.threatSearch && threats.sizeByPlayer(root->moveMade.player) == 0 && hasThreatSpaceWin(playerToMove, threats, budget, nullptr)) {
+		setNodeValue(root, playerToMove);
+		return;
+	}
+	if (options.leafInitialization == LeafInitialization::MOBILITY) {
+		initializeLeaf(root, threats.sizeByPlayer(root->moveMade.player) > 0 ? 1 : board.getEmptyFieldsCount());
+	}
+}
+
+void NmkEngine::initializeLeaf(Node* node, int mobility) const {
+	if (node->type == Type::OR) {
+		node->disproof *= mobility;
+	} else {
+		node->proof *= mobility;
+	}
+}
+
+bool NmkEngine::hasThreatSpaceWin(const Player& attacker, const ThreatSet& threats, int& budget, int* winningCell) const {
+	Player defender = attacker.getOpponent();
+	int width = board.getWidth();
+	ThreatSet candidates(width, board.getHeight());
+	board.collectThreatMoves(attacker, candidates);
+	for (int cell = candidates.findNext(attacker, 0); cell != -1 && budget > 0; cell = candidates.findNext(attacker, cell + 1)) {
+		budget--;
+		Move attack(attacker, cell % width, cell / width);
+		board.makeAMove(attack);
+		ThreatSet next(threats);
+		addThreats(attack, next);
+		bool won = next.sizeByPlayer(attacker) >= 2;
+		if (next.sizeByPlayer(attacker) == 1 && !board.isFull()) {
+			int blocked = next.findNext(attacker, 0);
+			Move defence(defender, blocked % width, blocked / width);
+			board.makeAMove(defence);
+			next.remove(attacker, defence.x, defence.y);
+			if (board.getCreatedThreatCount() == 0 && !board.isFull()) {
+				won = hasThreatSpaceWin(attacker, next, budget, nullptr);
+			}
+			board.undoMove(defence);
+		}
+		board.undoMove(attack);
+		if (won) {
+			if (winningCell != nullptr) {
+				*winningCell = cell;
+			}
+			return true;
+		}
+	}
+	return false;
 }
 
-void NmkEngine::setProofAndDisproofNumbers(Node* node) {
+void NmkEngine::setProofAndDisproofNumbers(Node* node) const {
 	if (!node->expanded) {
 		switch (node->value) {
-		case Value::DISPROVEN: case Value::DRAWN:
+		case Value::DRAWN:
+			if (goal == Goal::NOT_LOSING) {
+				node->proof = 0;
+				node->disproof = INFINTE;
+				break;
+			}
+			node->proof = INFINTE;
+			node->disproof = 0;
+			break;
+		case Value::DISPROVEN:
 			node->proof = INFINTE;
 			node->disproof = 0;
 			break;
@@ -78,79 +574,66 @@ void NmkEngine::setProofAndDisproofNumbers(Node* node) {
 			node->disproof = INFINTE;
 			break;
 		case Value::UNKNOWN:
-			node->proof = 1;
-			node->disproof = 1;
 			break;
 		}
 		return;
 	}
-	if (node->type == Type::AND) {
-		node->proof = 0;
-		node->disproof = INFINTE;
-		for (int i = 0; i < node->childrenCount; i++) {
-			Node* child = node->children[i];
-			node->proof += child->proof;
-			if (node->proof < 0) node->proof = INFINTE;
-			if (child->disproof < node->disproof) {
-				node->disproof = child->disproof;
-			}
-		}
-	} else {
-		node->proof = INFINTE;
-		node->disproof = 0;
-		for (int i = 0; i < node->childrenCount; i++) {
-			Node* child = node->children[i];
-			node->disproof += child->disproof;
-			if (node->disproof < 0) node->disproof = INFINTE;
-			if (child->proof < node->proof) {
-				node->proof = child->proof;
-			}
+	bool andNode = node->type == Type::AND;
+	int64_t sum = 0;
+	int min = INFINTE;
+	int best = 0;
+	for (int i = 0; i < node->childrenCount; i++) {
+		const Node* child = &node->children[i];
+		int minimized = andNode ? child->disproof : child->proof;
+		sum += andNode ? child->proof : child->disproof;
+		if (minimized < min) {
+			min = minimized;
+			best = i;
 		}
 	}
+	int total = sum < INFINTE ? (int)sum : INFINTE;
+	node->proof = andNode ? total : min;
+	node->disproof = andNode ? min : total;
+	node->bestChild = best;
 }
 
 NmkEngine::Node* NmkEngine::selectMostProvingNode(Node* node) {
+	STATS_TIMER(selectSeconds);
+	node->visited = iterations;
 	while (node->expanded) {
-		int i = 0;
-		Node* child = node->children[i++];
-		if (node->type == Type::OR) {
-			while (node->proof != child->proof) {
-				child = node->children[i++];
-			}
-		} else {
-			while (node->disproof != child->disproof) {
-				child = node->children[i++];
-			}
-		}
-		node = child;
+		node = &node->children[node->bestChild];
+		node->visited = iterations;
 		board.makeAMove(node->moveMade);
 	}
 	return node;
 }
 
 void NmkEngine::expandNode(Node* node) {
+	expandedNodes++;
+	STATS(stats.nodesExpanded++);
+	STATS(stats.recordDepth(board.getEmptyFieldsCount()));
 	generateChildren(node);
 	for (int i = 0; i < node->childrenCount; i++) {
-		Node* child = node->children[i];
+		Node* child = &node->children[i];
 		board.makeAMove(child->moveMade);
 		evaluate(child);
 		setProofAndDisproofNumbers(child);
 		board.undoMove(child->moveMade);
-		if (node->type == Type::AND) {
-			if (child->disproof == 0) break;
-		} else {
-			if (child->proof == 0) break;
+		if (node->type == Type::AND ? child->disproof == 0 : child->proof == 0) {
+			STATS(stats.earlyCutoffs++);
+			break;
 		}
 	}
 	node->expanded = true;
 }
 
 NmkEngine::Node* NmkEngine::updateAncestors(Node* node, Node* root) {
+	STATS_TIMER(updateSeconds);
+	int oldProof = node->proof;
+	int oldDisproof = node->disproof;
+	setProofAndDisproofNumbers(node);
 	do {
-		int oldProof = node->proof;
-		int oldDisproof = node->disproof;
-
-		setProofAndDisproofNumbers(node);
+		table.store(positionKey(node), node->proof, node->disproof, node->value, 1);
 		if (node->proof == oldProof && node->disproof == oldDisproof) {
 			return node;
 		}
@@ -158,234 +641,266 @@ NmkEngine::Node* NmkEngine::updateAncestors(Node* node, Node* root) {
 			return node;
 		}
 		board.undoMove(node->moveMade);
+		Node* child = node;
+		int childOldProof = oldProof;
+		int childOldDisproof = oldDisproof;
 		node = node->parent;
+		oldProof = node->proof;
+		oldDisproof = node->disproof;
+		applyChildChange(node, child, childOldProof, childOldDisproof);
 	} while (true);
 }
 
-void NmkEngine::generateChildren(Node* node) {
-	if (board.isFull()) {
-		node->childrenCount = 0;
+void NmkEngine::applyChildChange(Node* node, const Node* child, int oldProof, int oldDisproof) const {
+	bool andNode = node->type == Type::AND;
+	int& total = andNode ? node->proof : node->disproof;
+	int& min = andNode ? node->disproof : node->proof;
+	int oldSummed = andNode ? oldProof : oldDisproof;
+	int newSummed = andNode ? child->proof : child->disproof;
+	int newMinimized = andNode ? child->disproof : child->proof;
+	int index = (int)(child - node->children);
+	if (total == INFINTE || oldSummed == INFINTE || newSummed == INFINTE || (index == node->bestChild && newMinimized > min)) {
+		setProofAndDisproofNumbers(node);
 		return;
 	}
-	LinkedMoveList* possibleMoves = generatePossibleMoves(node->moveMade.player.getOpponent(), *node->threats);
-	node->children = new Node * [possibleMoves->getSize()];
-	node->childrenCount = possibleMoves->getSize();
-	Type oppositeType = node->getOppositeType();
-	int i = 0;
-	for (LinkedMoveList::Iterator it = possibleMoves->start(); it.hasNext(); it.next()) {
-		node->children[i++] = new Node(node, it.get(), oppositeType, new LinkedMoveList(*node->threats));
+	int64_t sum = (int64_t)total - oldSummed + newSummed;
+	total = sum < INFINTE ? (int)sum : INFINTE;
+	if (newMinimized < min || (newMinimized == min && index < node->bestChild)) {
+		min = newMinimized;
+		node->bestChild = index;
 	}
-	delete possibleMoves;
 }
 
-bool NmkEngine::detectTie(Node* node) {
-	if (node->childrenCount == 0) {
-		if (node->value == Value::UNKNOWN) {
-			evaluate(node);
-		}
-		if (node->value == Value::UNKNOWN) {
-			generateChildren(node);
-			return detectTie(node);
+NmkEngine::Node* NmkEngine::collectGarbage(Node* root) {
+	int count = refreshVisits(root);
+	Expansion* expansions = new Expansion[count];
+	int listed = 0;
+	listExpansions(root, expansions, listed);
+	std::sort(expansions, expansions + count, isNewerExpansion);
+	std::size_t retained = sizeof(Node);
+	uint32_t cutoff = root->visited;
+	for (int i = 0; i < count;) {
+		std::size_t group = 0;
+		int j = i;
+		for (; j < count && expansions[j].visited == expansions[i].visited; j++) {
+			group += expansions[j].bytes;
 		}
-		return node->value == Value::DRAWN || node->value == Value::PROVEN;
-	}
-	if (node->type == Type::AND) {
-		for (int i = 0; i < node->childrenCount; i++) {
-			Node* child = node->children[i];
-			board.makeAMove(child->moveMade);
-			if (!detectTie(child)) {
-				board.undoMove(child->moveMade);
-				return false;
-			}
-			board.undoMove(child->moveMade);
+		if (i > 0 && retained + group > memoryLimit / 4) {
+			break;
 		}
-		return true;
+		retained += group;
+		cutoff = expansions[i].visited;
+		i = j;
 	}
-	for (int i = 0; i < node->childrenCount; i++) {
-		Node* child = node->children[i];
-		board.makeAMove(child->moveMade);
-		if (detectTie(child)) {
-			board.undoMove(child->moveMade);
-			return true;
-		}
-		board.undoMove(child->moveMade);
+	delete[] expansions;
+	Node* copy = spareArena.create<Node>(*root);
+	int64_t kept = 1;
+	copyRetained(copy, cutoff, kept);
+	STATS(stats.treeSize = kept);
+	STATS(stats.collections++);
+	arena.reset();
+	arena.swap(spareArena);
+	if (arena.getStats().bytesInUse >= memoryLimit / 2) {
+		exhausted = true;
 	}
-	return false;
+	return copy;
 }
 
-void NmkEngine::setNodeValue(Node* node, Player& winningPlayer) const {
-	node->value = winningPlayer == player ? Value::PROVEN : Value::DISPROVEN;
-}
-
-LinkedMoveList* NmkEngine::generatePossibleMoves(const Player& currPlayer, LinkedMoveList& threats) {
-	LinkedMoveList* solutions = new LinkedMoveList();
-	if (threats.sizeByPlayer(currPlayer.getOpponent()) > 0) {
-		for (LinkedMoveList::Iterator it = threats.start(); it.hasNext(); it.next()) {
-			if (it.get().player != currPlayer) {
-				solutions->push(new Move(currPlayer, it.get().x, it.get().y));
-			}
-		}
-		return solutions;
+int NmkEngine::refreshVisits(Node* node) {
+	if (!node->expanded || node->proof == 0 || node->disproof == 0) {
+		return 0;
 	}
-
-	for (int y = 0; y < board.getHeight(); y++) {
-		for (int x = 0; x < board.getWidth(); x++) {
-			if (board.getPlayer(x, y) == Player::NONE) {
-				solutions->push(new Move(currPlayer, x, y));
-			}
+	int count = 1;
+	for (int i = 0; i < node->childrenCount; i++) {
+		Node* child = &node->children[i];
+		count += refreshVisits(child);
+		if (child->visited > node->visited) {
+			node->visited = child->visited;
 		}
 	}
-	return solutions;
+	return count;
 }
 
-bool NmkEngine::isWinning(int x, int y) const {
-	return isWinning(x, y, 1, 0)
-		|| isWinning(x, y, 0, 1)
-		|| isWinning(x, y, 1, 1)
-		|| isWinning(x, y, 1, -1);
+void NmkEngine::listExpansions(const Node* node, Expansion* expansions, int& count) const {
+	if (!node->expanded || node->proof == 0 || node->disproof == 0) {
+		return;
+	}
+	expansions[count].visited = node->visited;
+	expansions[count].bytes = expansionBytes(node);
+	count++;
+	for (int i = 0; i < node->childrenCount; i++) {
+		listExpansions(&node->children[i], expansions, count);
+	}
 }
 
-bool NmkEngine::isWinning(int startX, int startY, int dx, int dy) const {
-	int counter = 1 + howManyInDirection(startX, startY, dx, dy) + howManyInDirection(startX, startY, -dx, -dy);
-	return counter >= minToWin;
+bool NmkEngine::isNewerExpansion(const Expansion& first, const Expansion& second) {
+	return first.visited > second.visited;
 }
 
-int NmkEngine::howManyInDirection(int startX, int startY, int dx, int dy) const {
-	Player currPlayer = board.getPlayer(startX, startY);
-	int counter = 0;
-	int x = startX + dx;
-	int y = startY + dy;
-	while (board.withinBounds(x, y)) {
-		if (board.getPlayer(x, y) != currPlayer) {
-			break;
-		}
-		counter++;
-		x += dx;
-		y += dy;
+void NmkEngine::copyRetained(Node* node, uint32_t cutoff, int64_t& kept) {
+	if (!node->expanded) {
+		return;
 	}
-	return counter;
-}
-
-void NmkEngine::removeBlockedThreats(Move& currMove, LinkedMoveList& threats) const {
-	for (LinkedMoveList::Iterator it = threats.start(); it.hasNext(); it.next()) {
-		if (it.get().x == currMove.x && it.get().y == currMove.y && it.get().player != currMove.player) {
-			it.remove();
+	if (node->proof == 0 || node->disproof == 0 || node->visited < cutoff) {
+		if (node->proof == 0) {
+			node->value = Value::PROVEN;
+		} else if (node->disproof == 0) {
+			node->value = Value::DISPROVEN;
 		}
+		node->releaseChildren();
+		node->threats = nullptr;
+		return;
+	}
+	Node* children = spareArena.allocateArray<Node>(node->childrenCount);
+	for (int i = 0; i < node->childrenCount; i++) {
+		new (&children[i]) Node(node->children[i]);
+		children[i].parent = node;
+		copyRetained(&children[i], cutoff, kept);
 	}
+	kept += node->childrenCount;
+	node->children = children;
+	node->threats = spareArena.create<ThreatSet>(*node->threats, spareArena);
 }
 
-bool NmkEngine::moveWasWinning(Move& currMove, LinkedMoveList& threats) {
-	return threats.contains(currMove.player, currMove.x, currMove.y);
+std::size_t NmkEngine::expansionBytes(const Node* node) const {
+	std::size_t words = (board.getWidth() * board.getHeight() + 63) / 64;
+	std::size_t bytes = node->childrenCount * sizeof(Node) + sizeof(ThreatSet);
+	return words > THREAT_SET_INLINE_WORDS ? bytes + 2 * words * sizeof(uint64_t) : bytes;
 }
 
-void NmkEngine::addThreats(Move& currMove, LinkedMoveList& threats) const {
-	if (!currMove.moveIsKnown()) {
+void NmkEngine::generateChildren(Node* node) {
+	if (board.isFull()) {
+		node->childrenCount = 0;
 		return;
 	}
-	addThreats(currMove, threats, 1, 0);
-	addThreats(currMove, threats, 0, 1);
-	addThreats(currMove, threats, 1, 1);
-	addThreats(currMove, threats, 1, -1);
-}
-
-void NmkEngine::addThreats(Move& currMove, LinkedMoveList& threats, int dx, int dy) const {
-	int counterNormal = 0;
-	int counterReversed = 0;
-	int skipCounterNormal = 0;
-	int skipCounterReversed = 0;
-	Move* skipNormal = howManyInDirectionWithSkip(currMove, dx, dy, counterNormal, skipCounterNormal);
-	Move* skipReversed = howManyInDirectionWithSkip(currMove, -dx, -dy, counterReversed, skipCounterReversed);
-	int counter = counterNormal + counterReversed;
-	if (skipNormal != nullptr) {
-		if (counter + skipCounterNormal + 2 >= minToWin && !threats.contains(skipNormal->player, skipNormal->x, skipNormal->y)) {
-			threats.push(skipNormal);
-		} else {
-			delete skipNormal;
+	materializeThreats(node);
+	int count;
+	Move* possibleMoves = generatePossibleMoves(node->moveMade.player.getOpponent(), *node->threats, count);
+	node->children = arena.allocateArray<Node>(count);
+	node->childrenCount = count;
+	STATS(stats.growTree(count));
+	int* scores = orderMoves(possibleMoves, count);
+	Type oppositeType = node->getOppositeType();
+	for (int i = 0; i < count; i++) {
+		new (&node->children[i]) Node(node, possibleMoves[i], oppositeType);
+		if (scores != nullptr) {
+			seedProofNumbers(&node->children[i], scores[i], scores[0]);
 		}
 	}
-	if (skipReversed != nullptr) {
-		if (counter + skipCounterReversed + 2 >= minToWin && !threats.contains(skipReversed->player, skipReversed->x, skipReversed->y)) {
-			threats.push(skipReversed);
-		} else {
-			delete skipReversed;
-		}
+	moveArena.reset();
+}
+
+int* NmkEngine::orderMoves(Move* moves, int count) {
+	if (options.ordering == MoveOrdering::NONE || count < 2) {
+		return nullptr;
 	}
-	if (counter + 2 >= minToWin) {
-		int startX = currMove.x;
-		int startY = currMove.y;
-		int normalX = startX + dx * (counterNormal + 1);
-		int normalY = startY + dy * (counterNormal + 1);
-		int reversedX = startX - dx * (counterReversed + 1);
-		int reversedY = startY - dy * (counterReversed + 1);
-		Player currPlayer = currMove.player;
-		if (board.withinBounds(normalX, normalY) && board.getPlayer(normalX, normalY) == Player::NONE && !threats.contains(currPlayer, normalX, normalY)) {
-			threats.push(new Move(currPlayer, normalX, normalY));
-		}
-		if (board.withinBounds(reversedX, reversedY) && board.getPlayer(reversedX, reversedY) == Player::NONE && !threats.contains(currPlayer, reversedX, reversedY)) {
-			threats.push(new Move(currPlayer, reversedX, reversedY));
+	int* scores = moveArena.allocateArray<int>(count);
+	for (int i = 0; i < count; i++) {
+		int score = board.scoreCell(moves[i].x, moves[i].y, moves[i].player);
+		Move move = moves[i];
+		int j = i;
+		for (; j > 0 && scores[j - 1] < score; j--) {
+			scores[j] = scores[j - 1];
+			moves[j] = moves[j - 1];
 		}
+		scores[j] = score;
+		moves[j] = move;
+	}
+	return scores;
+}
+
+void NmkEngine::seedProofNumbers(Node* child, int score, int bestScore) const {
+	int seed = 1 + (bestScore - score) * (ORDERING_SEED_RANGE - 1) / std::max(1, bestScore);
+	if (child->moveMade.player == player) {
+		child->proof = seed;
+	} else {
+		child->disproof = seed;
 	}
 }
 
-Move* NmkEngine::howManyInDirectionWithSkip(Move& currMove, int dx, int dy, int& counter, int& skipCounter) const {
-	Move* skip = nullptr;
-	int x = currMove.x + dx;
-	int y = currMove.y + dy;
-	Player currPlayer = currMove.player;
+void NmkEngine::setNodeValue(Node* node, Player& winningPlayer) const {
+	node->value = winningPlayer == player ? Value::PROVEN : Value::DISPROVEN;
+}
+
+Move* NmkEngine::generatePossibleMoves(const Player& currPlayer, const ThreatSet& threats, int& count) {
 	Player opponent = currPlayer.getOpponent();
-	while (board.withinBounds(x, y)) {
-		Player pl = board.getPlayer(x, y);
-		if (pl == opponent) {
-			break;
-		}
-		if (pl == Player::NONE) {
-			if (!(board.withinBounds(x + dx, y + dy) && board.getPlayer(x + dx, y + dy) == currPlayer)) {
-				break;
-			}
-			skip = new Move(currPlayer, x, y);
-			x += dx;
-			y += dy;
-			while (board.withinBounds(x, y) && board.getPlayer(x, y) == currPlayer) {
-				skipCounter++;
-				x += dx;
-				y += dy;
+	count = 0;
+	int symmetries[BOARD_SYMMETRIES];
+	int symmetryCount = board.findSymmetries(symmetries);
+	if (threats.sizeByPlayer(opponent) > 0) {
+		Move* solutions = moveArena.allocateArray<Move>(threats.sizeByPlayer(opponent));
+		int width = threats.getWidth();
+		for (int index = threats.findNext(opponent, 0); index != -1; index = threats.findNext(opponent, index + 1)) {
+			if (board.isCanonicalCell(index % width, index / width, symmetries, symmetryCount)) {
+				new (&solutions[count++]) Move(currPlayer, index % width, index / width);
 			}
-			break;
 		}
-		counter++;
-		x += dx;
-		y += dy;
+		return solutions;
 	}
-	return skip;
-}
 
-void NmkEngine::fillThreatsAtStart(LinkedMoveList& threats) const {
+	Move* solutions = moveArena.allocateArray<Move>(board.getEmptyFieldsCount());
 	for (int y = 0; y < board.getHeight(); y++) {
 		for (int x = 0; x < board.getWidth(); x++) {
-			if (board.getPlayer(x, y) != Player::NONE) {
-				Move move(board.getPlayer(x, y), x, y);
-				addThreats(move, threats);
+			if (board.getPlayer(x, y) == Player::NONE && board.isCanonicalCell(x, y, symmetries, symmetryCount)) {
+				new (&solutions[count++]) Move(currPlayer, x, y);
 			}
 		}
 	}
+	return solutions;
 }
 
-Player NmkEngine::getWinningPlayer(int result) const {
-	return result == WIN ? player : player.getOpponent();
+void NmkEngine::removeBlockedThreats(Move& currMove, ThreatSet& threats) {
+	if (currMove.moveIsKnown()) {
+		threats.remove(currMove.player.getOpponent(), currMove.x, currMove.y);
+	}
 }
 
+bool NmkEngine::moveWasWinning(Move& currMove, ThreatSet& threats) {
+	return currMove.moveIsKnown() && threats.contains(currMove.player, currMove.x, currMove.y);
+}
 
-NmkEngine::Node::Node(Node* parent, Move move, Type type, LinkedMoveList* threats) : parent(parent), children(nullptr), proof(1), disproof(1), childrenCount(0), type(type), expanded(false), moveMade(move), value(Value::UNKNOWN), threats(threats) {
+void NmkEngine::addThreats(Move& currMove, ThreatSet& threats) const {
+	if (!currMove.moveIsKnown()) {
+		return;
+	}
+	for (int i = 0; i < board.getCreatedThreatCount(); i++) {
+		int cell = board.getCreatedThreat(i);
+		threats.add(currMove.player, cell % board.getWidth(), cell / board.getWidth());
+	}
 }
 
-NmkEngine::Node::~Node() {
-	for (int i = 0; i < childrenCount; i++) {
-		delete children[i];
+void NmkEngine::materializeThreats(Node* node) {
+	if (node->threats != nullptr) {
+		return;
 	}
-	delete[] children;
-	delete threats;
+	node->threats = arena.create<ThreatSet>(*node->parent->threats, arena);
+	removeBlockedThreats(node->moveMade, *node->threats);
+	board.collectThreatsThrough(node->moveMade.x, node->moveMade.y, node->moveMade.player, *node->threats);
+}
+
+void NmkEngine::fillThreatsAtStart(ThreatSet& threats) const {
+	board.collectThreats(threats);
+}
+
+Player NmkEngine::getWinningPlayer(int result) const {
+	return result == WIN ? player : player.getOpponent();
+}
+
+uint64_t NmkEngine::positionKey(const Node* node) const {
+	return board.getHash() ^ Zobrist::sideKey(node->moveMade.player.getOpponent()) ^ searchKey;
+}
+
+
+NmkEngine::Node::Node(Node* parent, Move move, Type type) : proof(1), disproof(1), childrenCount(0), bestChild(0), type(type), expanded(false), value(Value::UNKNOWN), visited(0),
+	children(nullptr), parent(parent), key(0), moveMade(move), threats(nullptr) {
 }
 
 NmkEngine::Type NmkEngine::Node::getOppositeType() const {
 	return type == Type::AND ? Type::OR : Type::AND;
 }
+
+void NmkEngine::Node::releaseChildren() {
+	children = nullptr;
+	childrenCount = 0;
+	expanded = false;
+}
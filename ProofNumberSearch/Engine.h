@@ -1,72 +1,173 @@
 #pragma once
 
+#include "Arena.h"
 #include "Board.h"
-#include "LinkedMoveList.h"
+#include "Move.h"
 #include "Player.h"
+#include "SearchStats.h"
+#include "SolverOptions.h"
+#include "ThreatSet.h"
+#include "TranspositionTable.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 
 #define MESSAGE_TIE "BOTH_PLAYERS_TIE\n"
 #define MESSAGE_P1 "FIRST_PLAYER_WINS\n"
 #define MESSAGE_P2 "SECOND_PLAYER_WINS\n"
+#define MESSAGE_UNKNOWN "UNKNOWN\n"
 
 #define WIN 1
 #define LOSS -1
 #define TIE 0
 
 #define INFINTE INT_MAX
+#define VIRTUAL_PROOF_PENALTY 4
+#define DEADLINE_CHECK_INTERVAL 1024
+#define ORDERING_SEED_RANGE 4
+#define THREAT_SEARCH_BUDGET 16
+#define RETRY_BUDGET_GROWTH 2
+#define MAX_RESPONSE_LENGTH 256
+#define MAX_PV_LENGTH 16
 
+class Arena;
 class Board;
-class LinkedMoveList;
 class Player;
+class SolvedDatabase;
+class ThreatSet;
+class TranspositionTable;
 struct Move;
 
+enum class SolveResult {
+	FIRST_PLAYER_WINS, SECOND_PLAYER_WINS, BOTH_PLAYERS_TIE, UNKNOWN
+};
+
 class NmkEngine {
 	enum class Type {
 		AND, OR
 	};
-	enum class Value {
-		DISPROVEN, PROVEN, UNKNOWN, DRAWN
+	enum class Goal {
+		WINNING, NOT_LOSING
 	};
+	using Value = ProofValue;
 	struct Node {
-		explicit Node(Node* parent, Move move, Type type, LinkedMoveList* threats);
-		~Node();
-		Node* parent;
-		Node** children;
+		explicit Node(Node* parent, Move move, Type type);
 		int proof;
 		int disproof;
 		int childrenCount;
+		int bestChild;
 		Type type;
 		bool expanded;
-		Move moveMade;
 		Value value;
-		LinkedMoveList* threats;
+		uint32_t visited;
+		Node* children;
+		Node* parent;
+		uint64_t key;
+		Move moveMade;
+		ThreatSet* threats;
 		Type getOppositeType() const;
+		void releaseChildren();
+	};
+	struct Expansion {
+		uint32_t visited;
+		std::size_t bytes;
 	};
 public:
-	NmkEngine(Board& board, int k, Player player);
-	void solve();
+	NmkEngine(Board& board, int k, Player player, TranspositionTable& table, const SolverOptions& options);
+	SolveResult solve();
+	SolveResult solveWithRetries(int retries);
+	void setTimeLimit(double seconds);
+	void setNodeLimit(uint64_t nodes);
+	void setMemoryLimit(std::size_t bytes);
+	void setReportMove(bool report);
+	void setDatabase(SolvedDatabase* solvedDatabase);
+	Arena::Stats getAllocationStats() const;
+	uint64_t getExpandedNodes() const;
+	const SearchStats& getStats() const;
+	void writeResult(SolveResult result, char* buffer, int capacity) const;
+	static const char* getResultMessage(SolveResult result);
 private:
 	Board& board;
 	int minToWin;
 	Player player;
-	int proofNumberSearch(Node* root);
+	TranspositionTable& table;
+	SolverOptions options;
+	SolvedDatabase* database;
+	Goal goal;
+	uint64_t configKey;
+	uint64_t searchKey;
+	uint32_t iterations;
+	uint64_t expandedNodes;
+	mutable SearchStats stats;
+	Arena arena;
+	Arena spareArena;
+	Arena moveArena;
+	int workerId;
+	std::atomic<bool>* stopFlag;
+	std::chrono::steady_clock::time_point deadline;
+	bool hasDeadline;
+	double timeLimit;
+	uint64_t nodeLimit;
+	std::size_t memoryLimit;
+	uint64_t nodesAtStart;
+	bool exhausted;
+	uint32_t stopChecks;
+	Node* pausedRoot;
+	bool winningRefuted;
+	Goal progressGoal;
+	int progressProof;
+	int progressDisproof;
+	int bestX;
+	int bestY;
+	bool reportMove;
+	int pvLength;
+	int pvMoves[2 * MAX_PV_LENGTH];
+	Node* createRoot();
+	SolveResult searchResult();
+	int searchWithGoals();
+	Value search(Goal searchGoal);
+	Value proofNumberSearch(Goal searchGoal);
+	Value depthFirstSearch(Goal searchGoal);
+	Value parallelDepthFirstSearch(Goal searchGoal);
+	void runHelper(int id, Board* localBoard, Goal searchGoal, std::atomic<bool>* stop, std::atomic<int>* outcome) const;
+	static void reportOutcome(Value outcome, std::atomic<bool>* stop, std::atomic<int>* sharedOutcome);
+	bool isStopped();
+	void recordProgress(Node* root);
+	void findPrincipalVariation(SolveResult result);
+	int findDecisiveMove(const Player& mover, bool proven);
+	void refreshChildren(Node* node);
+	int widenThreshold(int second) const;
+	int selectionNumber(const Node* node, const Node* child, bool penalize) const;
+	void multipleIterativeDeepening(Node* node, int proofThreshold, int disproofThreshold);
+	Node* selectChild(Node* node, int proofThreshold, int disproofThreshold, int& childProofThreshold, int& childDisproofThreshold, bool penalize) const;
+	void setGoal(Goal searchGoal);
 	void evaluate(Node* root) const;
-	static void setProofAndDisproofNumbers(Node* node);
+	void evaluatePosition(Node* root, ThreatSet& threats) const;
+	void initializeLeaf(Node* node, int mobility) const;
+	bool hasThreatSpaceWin(const Player& attacker, const ThreatSet& threats, int& budget, int* winningCell) const;
+	void setProofAndDisproofNumbers(Node* node) const;
 	Node* selectMostProvingNode(Node* node);
 	void expandNode(Node* node);
 	Node* updateAncestors(Node* node, Node* root);
+	void applyChildChange(Node* node, const Node* child, int oldProof, int oldDisproof) const;
+	Node* collectGarbage(Node* root);
+	int refreshVisits(Node* node);
+	void listExpansions(const Node* node, Expansion* expansions, int& count) const;
+	static bool isNewerExpansion(const Expansion& first, const Expansion& second);
+	void copyRetained(Node* node, uint32_t cutoff, int64_t& kept);
+	std::size_t expansionBytes(const Node* node) const;
 	void generateChildren(Node* node);
 	void setNodeValue(Node* node, Player& winningPlayer) const;
-	bool isWinning(int x, int y) const;
-	bool isWinning(int startX, int startY, int dx, int dy) const;
-	int howManyInDirection(int startX, int startY, int dx, int dy) const;
-	void addThreats(Move& currMove, LinkedMoveList& threats) const;
-	void addThreats(Move& currMove, LinkedMoveList& threats, int dx, int dy) const;
-	Move* howManyInDirectionWithSkip(Move& currMove, int dx, int dy, int& counter, int& skipCounter) const;
-	LinkedMoveList* generatePossibleMoves(const Player& currPlayer, LinkedMoveList& threats);
-	void removeBlockedThreats(Move& currMove, LinkedMoveList& threats) const;
-	static bool moveWasWinning(Move& currMove, LinkedMoveList& threats);
+	void addThreats(Move& currMove, ThreatSet& threats) const;
+	Move* generatePossibleMoves(const Player& currPlayer, const ThreatSet& threats, int& count);
+	int* orderMoves(Move* moves, int count);
+	void seedProofNumbers(Node* child, int score, int bestScore) const;
+	static void removeBlockedThreats(Move& currMove, ThreatSet& threats);
+	static bool moveWasWinning(Move& currMove, ThreatSet& threats);
 	Player getWinningPlayer(int result) const;
-	void fillThreatsAtStart(LinkedMoveList& threats) const;
-	bool detectTie(Node* node);
+	void materializeThreats(Node* node);
+	void fillThreatsAtStart(ThreatSet& threats) const;
+	uint64_t positionKey(const Node* node) const;
 };
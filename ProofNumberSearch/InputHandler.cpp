@@ -1,37 +1,104 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include "InputHandler.h"
+#include "BatchSolver.h"
 #include "Board.h"
 #include "Engine.h"
 #include <assert.h>
 #include "Player.h"
+#include "SolveRequest.h"
+#include <chrono>
 #include <cstdio>
 #include <string.h>
 
+#define BATCH_INITIAL_CAPACITY 64
 
-#define MAX_INPUT_LENGTH 50
-#define SOLVE_COMMAND "SOLVE_GAME_STATE"
+InputHandler::InputHandler(const SolverOptions& options) : options(options), table(options.tableSizeInBytes), reader(stdin) {
+}
 
-void InputHandler::handle() {
-	char input[MAX_INPUT_LENGTH];
-	while (true) {
-		scanf("%s", input);
-		if (feof(stdin) != 0) {
-			break;
-		}
-		int height;
-		int width;
-		int minToWin;
-		int playerNum;
-		scanf("%d %d %d %d", &height, &width, &minToWin, &playerNum);
-		Player player = Player(playerNum);
-		Board board = Board(width, height);
-		board.read();
-		NmkEngine engine = NmkEngine(board, minToWin, player);
-		if (strcmp(input, SOLVE_COMMAND) == 0) {
-			engine.solve();
+bool InputHandler::handle() {
+	if (options.databasePath != nullptr && !database.open(options.databasePath)) {
+		return false;
+	}
+	if (options.batch) {
+		return handleBatch();
+	}
+	SolveRequest* request;
+	while ((request = SolveRequest::read(reader, options.algorithm)) != nullptr) {
+		SolverOptions requestOptions = options;
+		requestOptions.algorithm = request->algorithm;
+		if (!request->valid) {
+			printf("Invalid command: %s\n", request->command);
+		} else if (options.scalingThreads > 0) {
+			measureScaling(request->board, request->minToWin, request->player, requestOptions);
 		} else {
-			printf("Invalid command: %s\n", input);
+			table.newSearch();
+			NmkEngine engine(request->board, request->minToWin, request->player, table, requestOptions);
+			engine.setTimeLimit(options.timeLimit);
+			engine.setReportMove(request->reportMove);
+			engine.setDatabase(getDatabase());
+			char response[MAX_RESPONSE_LENGTH];
+			engine.writeResult(engine.solveWithRetries(options.retries), response, MAX_RESPONSE_LENGTH);
+			printf("%s", response);
+			if (options.printStats) {
+				fflush(stdout);
+				engine.getStats().print(stderr, request->command);
+			}
+			totalStats.add(engine.getStats());
+		}
+		delete request;
+	}
+	if (options.printStatsTotal) {
+		fflush(stdout);
+		totalStats.print(stderr, "total");
+	}
+	return !reader.hasFailed();
+}
+
+bool InputHandler::handleBatch() {
+	int count = 0;
+	int capacity = BATCH_INITIAL_CAPACITY;
+	SolveRequest** requests = new SolveRequest * [capacity];
+	SolveRequest* request;
+	while ((request = SolveRequest::read(reader, options.algorithm)) != nullptr) {
+		if (count == capacity) {
+			SolveRequest** grown = new SolveRequest * [capacity * 2];
+			memcpy(grown, requests, count * sizeof(SolveRequest*));
+			delete[] requests;
+			requests = grown;
+			capacity *= 2;
+		}
+		requests[count++] = request;
+	}
+	BatchSolver solver(options, requests, count, getDatabase());
+	solver.run();
+	for (int i = 0; i < count; i++) {
+		delete requests[i];
+	}
+	delete[] requests;
+	return !reader.hasFailed();
+}
+
+SolvedDatabase* InputHandler::getDatabase() {
+	return options.databasePath != nullptr ? &database : nullptr;
+}
+
+void InputHandler::measureScaling(Board& board, int minToWin, Player player, SolverOptions requestOptions) {
+	double baseline = 0;
+	requestOptions.algorithm = Algorithm::DFPN;
+	for (int threads = 1; ; threads = std::min(threads * 2, options.scalingThreads)) {
+		requestOptions.threads = threads;
+		table.clear();
+		NmkEngine engine(board, minToWin, player, table, requestOptions);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		SolveResult result = engine.solve();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (threads == 1) {
+			baseline = seconds;
+		}
+		printf("threads %d time %.3fs speedup %.2fx %s", threads, seconds, seconds > 0 ? baseline / seconds : 1.0, NmkEngine::getResultMessage(result));
+		if (threads == options.scalingThreads) {
+			break;
 		}
 	}
 }
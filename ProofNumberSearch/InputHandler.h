@@ -1,7 +1,24 @@
 #pragma once
 
+#include "Board.h"
+#include "InputReader.h"
+#include "Player.h"
+#include "SearchStats.h"
+#include "SolvedDatabase.h"
+#include "SolverOptions.h"
+#include "TranspositionTable.h"
+
 class InputHandler {
 public:
-	void handle();
+	explicit InputHandler(const SolverOptions& options);
+	bool handle();
+private:
+	SolverOptions options;
+	TranspositionTable table;
+	InputReader reader;
+	SearchStats totalStats;
+	SolvedDatabase database;
+	bool handleBatch();
+	SolvedDatabase* getDatabase();
+	void measureScaling(Board& board, int minToWin, Player player, SolverOptions requestOptions);
 };
-
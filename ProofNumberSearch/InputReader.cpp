@@ -0,0 +1,138 @@
+#include "InputReader.h"
+#include "Socket.h"
+#include <cerrno>
+#include <climits>
+
+#if defined(_WIN32)
+#include <io.h>
+#define READ_FILE(descriptor, buffer, capacity) _read(descriptor, buffer, (unsigned int)(capacity))
+#define FILE_DESCRIPTOR(file) _fileno(file)
+#else
+#include <unistd.h>
+#define READ_FILE(descriptor, buffer, capacity) ::read(descriptor, buffer, capacity)
+#define FILE_DESCRIPTOR(file) fileno(file)
+#endif
+
+InputReader::InputReader(FILE* file) : file(file), socket(nullptr), buffer(new char[INPUT_BLOCK_SIZE]), length(0), position(0), line(1), column(1), ended(false), failed(false) {
+	error[0] = '\0';
+}
+
+InputReader::InputReader(Socket& socket) : file(nullptr), socket(&socket), buffer(new char[INPUT_BLOCK_SIZE]), length(0), position(0), line(1), column(1), ended(false), failed(false) {
+	error[0] = '\0';
+}
+
+InputReader::~InputReader() {
+	delete[] buffer;
+}
+
+bool InputReader::atEnd() {
+	skipWhitespace();
+	return peek() == EOF;
+}
+
+bool InputReader::readWord(char* word, int capacity) {
+	skipWhitespace();
+	int startLine = line;
+	int startColumn = column;
+	int size = 0;
+	for (int c = peek(); c != EOF && c > ' '; c = peek()) {
+		if (size == capacity - 1) {
+			return fail(startLine, startColumn, "word is too long");
+		}
+		word[size++] = (char)c;
+		advance();
+	}
+	word[size] = '\0';
+	return size > 0 || fail(startLine, startColumn, "expected a word");
+}
+
+bool InputReader::readInt(int& value, int min, int max) {
+	skipWhitespace();
+	int startLine = line;
+	int startColumn = column;
+	bool negative = peek() == '-';
+	if (negative) {
+		advance();
+	}
+	if (peek() < '0' || peek() > '9') {
+		return fail(startLine, startColumn, "expected an integer");
+	}
+	long long result = 0;
+	for (int c = peek(); c >= '0' && c <= '9'; c = peek()) {
+		result = result * 10 + (c - '0');
+		if (result > INT_MAX) {
+			return fail(startLine, startColumn, "integer is out of range");
+		}
+		advance();
+	}
+	if (peek() != EOF && peek() > ' ') {
+		return fail(startLine, startColumn, "expected an integer");
+	}
+	if (negative) {
+		result = -result;
+	}
+	if (result < min || result > max) {
+		return fail(startLine, startColumn, "integer is out of range");
+	}
+	value = (int)result;
+	return true;
+}
+
+bool InputReader::hasFailed() const {
+	return failed;
+}
+
+const char* InputReader::getError() const {
+	return error;
+}
+
+int InputReader::peek() {
+	if (position == length) {
+		if (ended) {
+			return EOF;
+		}
+		length = socket != nullptr ? socket->receive(buffer, INPUT_BLOCK_SIZE) : readFile();
+		position = 0;
+		if (length == 0) {
+			ended = true;
+			return EOF;
+		}
+	}
+	return (unsigned char)buffer[position];
+}
+
+std::size_t InputReader::readFile() {
+	for (;;) {
+		long received = (long)READ_FILE(FILE_DESCRIPTOR(file), buffer, INPUT_BLOCK_SIZE);
+		if (received >= 0) {
+			return (std::size_t)received;
+		}
+		if (errno != EINTR) {
+			return 0;
+		}
+	}
+}
+
+void InputReader::advance() {
+	if (buffer[position++] == '\n') {
+		line++;
+		column = 1;
+	} else {
+		column++;
+	}
+}
+
+void InputReader::skipWhitespace() {
+	for (int c = peek(); c != EOF && c <= ' '; c = peek()) {
+		advance();
+	}
+}
+
+bool InputReader::fail(int errorLine, int errorColumn, const char* message) {
+	if (!failed) {
+		snprintf(error, INPUT_ERROR_LENGTH, "Malformed input at line %d, column %d: %s", errorLine, errorColumn, message);
+		fprintf(stderr, "%s\n", error);
+	}
+	failed = true;
+	return false;
+}
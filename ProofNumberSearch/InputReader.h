@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+#define INPUT_BLOCK_SIZE (1 << 16)
+#define INPUT_ERROR_LENGTH 128
+
+class Socket;
+
+class InputReader {
+public:
+	explicit InputReader(FILE* file);
+	explicit InputReader(Socket& socket);
+	~InputReader();
+	InputReader(const InputReader& other) = delete;
+	InputReader& operator=(const InputReader& other) = delete;
+	bool atEnd();
+	bool readWord(char* word, int capacity);
+	bool readInt(int& value, int min, int max);
+	bool hasFailed() const;
+	const char* getError() const;
+private:
+	FILE* file;
+	Socket* socket;
+	char* buffer;
+	std::size_t length;
+	std::size_t position;
+	int line;
+	int column;
+	bool ended;
+	bool failed;
+	char error[INPUT_ERROR_LENGTH];
+	int peek();
+	std::size_t readFile();
+	void advance();
+	void skipWhitespace();
+	bool fail(int errorLine, int errorColumn, const char* message);
+};
@@ -0,0 +1,77 @@
+#include "SearchStats.h"
+
+SearchStats::Timer::Timer(double& seconds) : seconds(seconds), start(std::chrono::steady_clock::now()) {
+}
+
+SearchStats::Timer::~Timer() {
+	seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+SearchStats::SearchStats() : nodesCreated(0), nodesExpanded(0), nodesEvaluated(0), earlyCutoffs(0), collections(0), threatsSeen(0), maxThreats(0), maxDepth(0), rootEmptyFields(0),
+	treeSize(0), maxTreeSize(0), evaluateSeconds(0), selectSeconds(0), updateSeconds(0) {
+}
+
+void SearchStats::growTree(int count) {
+	nodesCreated += count;
+	treeSize += count;
+	if (treeSize > maxTreeSize) {
+		maxTreeSize = treeSize;
+	}
+}
+
+void SearchStats::shrinkTree(int count) {
+	treeSize -= count;
+}
+
+void SearchStats::recordThreats(int count) {
+	threatsSeen += count;
+	if (count > maxThreats) {
+		maxThreats = count;
+	}
+}
+
+void SearchStats::recordDepth(int emptyFields) {
+	int depth = rootEmptyFields - emptyFields;
+	if (depth > maxDepth) {
+		maxDepth = depth;
+	}
+}
+
+void SearchStats::add(const SearchStats& other) {
+	nodesCreated += other.nodesCreated;
+	nodesExpanded += other.nodesExpanded;
+	nodesEvaluated += other.nodesEvaluated;
+	earlyCutoffs += other.earlyCutoffs;
+	collections += other.collections;
+	threatsSeen += other.threatsSeen;
+	if (other.maxThreats > maxThreats) {
+		maxThreats = other.maxThreats;
+	}
+	if (other.maxDepth > maxDepth) {
+		maxDepth = other.maxDepth;
+	}
+	if (other.maxTreeSize > maxTreeSize) {
+		maxTreeSize = other.maxTreeSize;
+	}
+	evaluateSeconds += other.evaluateSeconds;
+	selectSeconds += other.selectSeconds;
+	updateSeconds += other.updateSeconds;
+}
+
+void SearchStats::print(FILE* file, const char* label) const {
+	double averageThreats = nodesEvaluated > 0 ? (double)threatsSeen / nodesEvaluated : 0;
+	fprintf(file, "[%s] nodes created %llu, expanded %llu, evaluated %llu, early cutoffs %llu\n", label, (unsigned long long)nodesCreated,
+		(unsigned long long)nodesExpanded, (unsigned long long)nodesEvaluated, (unsigned long long)earlyCutoffs);
+	fprintf(file, "[%s] max depth %d, max tree size %lld, threats per node %.2f avg / %d max, tree collections %llu\n", label, maxDepth,
+		(long long)maxTreeSize, averageThreats, maxThreats, (unsigned long long)collections);
+	fprintf(file, "[%s] time in evaluate %.3fs, selectMostProvingNode %.3fs, updateAncestors %.3fs\n", label, evaluateSeconds,
+		selectSeconds, updateSeconds);
+}
+
+bool SearchStats::isEnabled() {
+#ifdef NMK_SEARCH_STATS
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef NMK_SEARCH_STATS
+#define STATS(statement) statement
+#define STATS_TIMER(field) SearchStats::Timer statsTimer(stats.field)
+#else
+#define STATS(statement)
+#define STATS_TIMER(field)
+#endif
+
+struct SearchStats {
+	class Timer {
+	public:
+		explicit Timer(double& seconds);
+		~Timer();
+	private:
+		double& seconds;
+		std::chrono::steady_clock::time_point start;
+	};
+	SearchStats();
+	uint64_t nodesCreated;
+	uint64_t nodesExpanded;
+	uint64_t nodesEvaluated;
+	uint64_t earlyCutoffs;
+	uint64_t collections;
+	uint64_t threatsSeen;
+	int maxThreats;
+	int maxDepth;
+	int rootEmptyFields;
+	int64_t treeSize;
+	int64_t maxTreeSize;
+	double evaluateSeconds;
+	double selectSeconds;
+	double updateSeconds;
+	void growTree(int count);
+	void shrinkTree(int count);
+	void recordThreats(int count);
+	void recordDepth(int emptyFields);
+	void add(const SearchStats& other);
+	void print(FILE* file, const char* label) const;
+	static bool isEnabled();
+};
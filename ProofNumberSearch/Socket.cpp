@@ -0,0 +1,125 @@
+#include "Socket.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#define INVALID_HANDLE ((intptr_t)INVALID_SOCKET)
+#define NATIVE_SOCKET(handle) ((SOCKET)(handle))
+#define CLOSE_SOCKET(handle) closesocket(NATIVE_SOCKET(handle))
+#define SHUTDOWN_BOTH SD_BOTH
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define INVALID_HANDLE ((intptr_t)-1)
+#define NATIVE_SOCKET(handle) ((int)(handle))
+#define CLOSE_SOCKET(handle) ::close(NATIVE_SOCKET(handle))
+#define SHUTDOWN_BOTH SHUT_RDWR
+#endif
+
+#if defined(MSG_NOSIGNAL)
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+Socket::Socket() : handle(INVALID_HANDLE) {
+}
+
+Socket::Socket(intptr_t handle) : handle(handle) {
+}
+
+Socket::~Socket() {
+	close();
+}
+
+bool Socket::startup() {
+#if defined(_WIN32)
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+		fprintf(stderr, "Cannot initialize Winsock\n");
+		return false;
+	}
+#endif
+	return true;
+}
+
+bool Socket::listen(int port) {
+	handle = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == INVALID_HANDLE) {
+		fprintf(stderr, "Cannot create a socket\n");
+		return false;
+	}
+	int reuse = 1;
+	setsockopt(NATIVE_SOCKET(handle), SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons((unsigned short)port);
+	if (bind(NATIVE_SOCKET(handle), (const sockaddr*)&address, sizeof(address)) != 0 || ::listen(NATIVE_SOCKET(handle), SOCKET_LISTEN_BACKLOG) != 0) {
+		fprintf(stderr, "Cannot listen on 127.0.0.1:%d\n", port);
+		close();
+		return false;
+	}
+	return true;
+}
+
+bool Socket::accept(Socket*& connection) {
+	intptr_t accepted = (intptr_t)::accept(NATIVE_SOCKET(handle), nullptr, nullptr);
+	if (accepted == INVALID_HANDLE) {
+		connection = nullptr;
+		return isTransientAcceptError();
+	}
+	connection = new Socket(accepted);
+	return true;
+}
+
+bool Socket::isTransientAcceptError() {
+#if defined(_WIN32)
+	int error = WSAGetLastError();
+	return error == WSAEINTR || error == WSAECONNRESET || error == WSAEMFILE || error == WSAENOBUFS || error == WSAEWOULDBLOCK;
+#else
+	return errno == EINTR || errno == ECONNABORTED || errno == EPROTO || errno == EMFILE || errno == ENFILE || errno == ENOBUFS
+		|| errno == ENOMEM || errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+int Socket::receive(char* buffer, int capacity) {
+	int received = (int)recv(NATIVE_SOCKET(handle), buffer, capacity, 0);
+	return received < 0 ? 0 : received;
+}
+
+bool Socket::send(const char* data, int length) {
+	while (length > 0) {
+		int sent = (int)::send(NATIVE_SOCKET(handle), data, length, SEND_FLAGS);
+		if (sent <= 0) {
+			return false;
+		}
+		data += sent;
+		length -= sent;
+	}
+	return true;
+}
+
+bool Socket::isOpen() const {
+	return handle != INVALID_HANDLE;
+}
+
+void Socket::shutdown() {
+	if (handle != INVALID_HANDLE) {
+		::shutdown(NATIVE_SOCKET(handle), SHUTDOWN_BOTH);
+	}
+}
+
+void Socket::close() {
+	if (handle != INVALID_HANDLE) {
+		CLOSE_SOCKET(handle);
+		handle = INVALID_HANDLE;
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#define SOCKET_LISTEN_BACKLOG 64
+
+class Socket {
+public:
+	Socket();
+	~Socket();
+	Socket(const Socket& other) = delete;
+	Socket& operator=(const Socket& other) = delete;
+	static bool startup();
+	bool listen(int port);
+	bool accept(Socket*& connection);
+	int receive(char* buffer, int capacity);
+	bool send(const char* data, int length);
+	bool isOpen() const;
+	void shutdown();
+	void close();
+private:
+	static bool isTransientAcceptError();
+	explicit Socket(intptr_t handle);
+	intptr_t handle;
+};
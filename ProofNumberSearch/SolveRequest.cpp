@@ -0,0 +1,56 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "SolveRequest.h"
+#include "InputReader.h"
+#include <string.h>
+
+#define SOLVE_COMMAND "SOLVE_GAME_STATE"
+#define SOLVE_PNS_COMMAND "SOLVE_GAME_STATE_PNS"
+#define SOLVE_DFPN_COMMAND "SOLVE_GAME_STATE_DFPN"
+#define SOLVE_AND_MOVE_COMMAND "SOLVE_AND_MOVE"
+
+SolveRequest::SolveRequest(int width, int height, int minToWin, Player player) : board(width, height), minToWin(minToWin), player(player),
+	algorithm(Algorithm::PNS), reportMove(false), valid(false), done(false), result(SolveResult::UNKNOWN) {
+	command[0] = '\0';
+	response[0] = '\0';
+}
+
+SolveRequest* SolveRequest::read(InputReader& reader, Algorithm defaultAlgorithm) {
+	char input[MAX_INPUT_LENGTH];
+	if (reader.atEnd() || !reader.readWord(input, MAX_INPUT_LENGTH)) {
+		return nullptr;
+	}
+	int height;
+	int width;
+	int minToWin;
+	int playerNum;
+	if (!reader.readInt(height, 1, MAX_BOARD_SIZE) || !reader.readInt(width, 1, MAX_BOARD_SIZE)
+		|| !reader.readInt(minToWin, 1, MAX_BOARD_SIZE) || !reader.readInt(playerNum, 1, 2)) {
+		return nullptr;
+	}
+	SolveRequest* request = new SolveRequest(width, height, minToWin, Player(playerNum));
+	if (!request->board.read(reader)) {
+		delete request;
+		return nullptr;
+	}
+	strcpy(request->command, input);
+	request->valid = parseCommand(input, defaultAlgorithm, request->algorithm, request->reportMove);
+	return request;
+}
+
+bool SolveRequest::parseCommand(const char* command, Algorithm defaultAlgorithm, Algorithm& algorithm, bool& reportMove) {
+	reportMove = false;
+	if (strcmp(command, SOLVE_COMMAND) == 0) {
+		algorithm = defaultAlgorithm;
+	} else if (strcmp(command, SOLVE_AND_MOVE_COMMAND) == 0) {
+		algorithm = defaultAlgorithm;
+		reportMove = true;
+	} else if (strcmp(command, SOLVE_PNS_COMMAND) == 0) {
+		algorithm = Algorithm::PNS;
+	} else if (strcmp(command, SOLVE_DFPN_COMMAND) == 0) {
+		algorithm = Algorithm::DFPN;
+	} else {
+		return false;
+	}
+	return true;
+}
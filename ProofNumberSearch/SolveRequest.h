@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Board.h"
+#include "Engine.h"
+#include "Player.h"
+#include "SearchStats.h"
+#include "SolverOptions.h"
+
+#define MAX_INPUT_LENGTH 50
+#define MAX_BOARD_SIZE 4096
+
+class InputReader;
+
+struct SolveRequest {
+	SolveRequest(int width, int height, int minToWin, Player player);
+	char command[MAX_INPUT_LENGTH];
+	Board board;
+	int minToWin;
+	Player player;
+	Algorithm algorithm;
+	bool reportMove;
+	bool valid;
+	bool done;
+	SolveResult result;
+	char response[MAX_RESPONSE_LENGTH];
+	SearchStats stats;
+	static SolveRequest* read(InputReader& reader, Algorithm defaultAlgorithm);
+private:
+	static bool parseCommand(const char* command, Algorithm defaultAlgorithm, Algorithm& algorithm, bool& reportMove);
+};
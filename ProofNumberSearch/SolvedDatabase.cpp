@@ -0,0 +1,152 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "SolvedDatabase.h"
+#include <cstring>
+
+#define EMPTY_SLOT ((uint8_t)SolveResult::UNKNOWN)
+
+SolvedDatabase::SolvedDatabase() : records(nullptr), capacity(0), size(0), file(nullptr) {
+}
+
+SolvedDatabase::~SolvedDatabase() {
+	if (file != nullptr) {
+		fclose(file);
+	}
+	delete[] records;
+}
+
+bool SolvedDatabase::open(const char* path) {
+	FILE* existing = fopen(path, "rb");
+	if (existing != nullptr) {
+		fclose(existing);
+		if (!load(path, false)) {
+			return false;
+		}
+	}
+	file = fopen(path, "ab");
+	if (file == nullptr) {
+		fprintf(stderr, "Cannot open solved database: %s\n", path);
+		return false;
+	}
+	if (existing == nullptr && !writeHeader(file)) {
+		fprintf(stderr, "Cannot write solved database: %s\n", path);
+		return false;
+	}
+	return true;
+}
+
+bool SolvedDatabase::merge(const char* path) {
+	return load(path, true);
+}
+
+bool SolvedDatabase::lookup(uint64_t key, SolveResult& result) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (size == 0) {
+		return false;
+	}
+	for (std::size_t index = key & (capacity - 1); records[index].result != EMPTY_SLOT; index = (index + 1) & (capacity - 1)) {
+		if (records[index].key == key) {
+			result = (SolveResult)records[index].result;
+			return true;
+		}
+	}
+	return false;
+}
+
+void SolvedDatabase::record(uint64_t key, SolveResult result, uint32_t proofSize) {
+	if (result == SolveResult::UNKNOWN) {
+		return;
+	}
+	Record record;
+	memset(&record, 0, sizeof(record));
+	record.key = key;
+	record.proofSize = proofSize;
+	record.result = (uint8_t)result;
+	std::lock_guard<std::mutex> guard(lock);
+	if (insert(record)) {
+		append(record);
+	}
+}
+
+std::size_t SolvedDatabase::getSize() const {
+	return size;
+}
+
+bool SolvedDatabase::load(const char* path, bool appendNew) {
+	FILE* input = fopen(path, "rb");
+	if (input == nullptr) {
+		fprintf(stderr, "Cannot open solved database: %s\n", path);
+		return false;
+	}
+	if (!readHeader(input)) {
+		fprintf(stderr, "Not a version %d solved database: %s\n", DATABASE_VERSION, path);
+		fclose(input);
+		return false;
+	}
+	Record record;
+	std::lock_guard<std::mutex> guard(lock);
+	while (fread(&record, sizeof(record), 1, input) == 1) {
+		if (record.result > (uint8_t)SolveResult::BOTH_PLAYERS_TIE) {
+			fprintf(stderr, "Corrupt record in solved database: %s\n", path);
+			fclose(input);
+			return false;
+		}
+		if (insert(record) && appendNew) {
+			append(record);
+		}
+	}
+	fclose(input);
+	return true;
+}
+
+bool SolvedDatabase::insert(const Record& record) {
+	if ((size + 1) * 2 > capacity) {
+		grow();
+	}
+	std::size_t index = record.key & (capacity - 1);
+	for (; records[index].result != EMPTY_SLOT; index = (index + 1) & (capacity - 1)) {
+		if (records[index].key == record.key) {
+			return false;
+		}
+	}
+	records[index] = record;
+	size++;
+	return true;
+}
+
+void SolvedDatabase::append(const Record& record) {
+	if (file == nullptr) {
+		return;
+	}
+	fwrite(&record, sizeof(record), 1, file);
+	fflush(file);
+}
+
+void SolvedDatabase::grow() {
+	Record* old = records;
+	std::size_t oldCapacity = capacity;
+	capacity = capacity == 0 ? DATABASE_INITIAL_CAPACITY : capacity * 2;
+	records = new Record[capacity];
+	for (std::size_t i = 0; i < capacity; i++) {
+		records[i].result = EMPTY_SLOT;
+	}
+	size = 0;
+	for (std::size_t i = 0; i < oldCapacity; i++) {
+		if (old[i].result != EMPTY_SLOT) {
+			insert(old[i]);
+		}
+	}
+	delete[] old;
+}
+
+bool SolvedDatabase::readHeader(FILE* input) {
+	char magic[DATABASE_MAGIC_LENGTH];
+	uint32_t version;
+	return fread(magic, 1, DATABASE_MAGIC_LENGTH, input) == DATABASE_MAGIC_LENGTH && memcmp(magic, DATABASE_MAGIC, DATABASE_MAGIC_LENGTH) == 0
+		&& fread(&version, sizeof(version), 1, input) == 1 && version == DATABASE_VERSION;
+}
+
+bool SolvedDatabase::writeHeader(FILE* output) {
+	uint32_t version = DATABASE_VERSION;
+	return fwrite(DATABASE_MAGIC, 1, DATABASE_MAGIC_LENGTH, output) == DATABASE_MAGIC_LENGTH && fwrite(&version, sizeof(version), 1, output) == 1 && fflush(output) == 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Engine.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#define DATABASE_MAGIC "NMKSOLVE"
+#define DATABASE_MAGIC_LENGTH 8
+#define DATABASE_VERSION 1
+#define DATABASE_INITIAL_CAPACITY 1024
+
+class SolvedDatabase {
+public:
+	SolvedDatabase();
+	~SolvedDatabase();
+	SolvedDatabase(const SolvedDatabase& other) = delete;
+	SolvedDatabase& operator=(const SolvedDatabase& other) = delete;
+	bool open(const char* path);
+	bool merge(const char* path);
+	bool lookup(uint64_t key, SolveResult& result);
+	void record(uint64_t key, SolveResult result, uint32_t proofSize);
+	std::size_t getSize() const;
+private:
+	struct Record {
+		uint64_t key;
+		uint32_t proofSize;
+		uint8_t result;
+		uint8_t reserved[3];
+	};
+	Record* records;
+	std::size_t capacity;
+	std::size_t size;
+	FILE* file;
+	std::mutex lock;
+	bool load(const char* path, bool appendNew);
+	bool insert(const Record& record);
+	void append(const Record& record);
+	void grow();
+	static bool readHeader(FILE* input);
+	static bool writeHeader(FILE* output);
+};
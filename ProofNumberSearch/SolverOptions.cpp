@@ -0,0 +1,152 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "SolverOptions.h"
+#include "SearchStats.h"
+#include "TranspositionTable.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string.h>
+#include <thread>
+
+#define MEGABYTE (1024 * 1024)
+#define DEFAULT_EPSILON 0.25
+
+static int parseThreadCount(long count) {
+	int result = count == 0 ? (int)std::thread::hardware_concurrency() : (int)count;
+	return result < 1 ? 1 : result;
+}
+
+SolverOptions::SolverOptions() : algorithm(Algorithm::PNS), ordering(MoveOrdering::WINDOWS), leafInitialization(LeafInitialization::MOBILITY), epsilon(DEFAULT_EPSILON), threatSearch(true), tableSizeInBytes((std::size_t)DEFAULT_TABLE_SIZE_MB * MEGABYTE), threads(1), scalingThreads(0), batch(false), serverPort(0), timeLimit(0), nodeLimit(0), memoryLimit(0), retries(0), benchmarkPath(nullptr), databasePath(nullptr), mergePath(nullptr), json(false), printStats(false), printStatsTotal(false) {
+}
+
+bool SolverOptions::parse(int argc, char** argv) {
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--pns") == 0) {
+			algorithm = Algorithm::PNS;
+		} else if (strcmp(arg, "--dfpn") == 0) {
+			algorithm = Algorithm::DFPN;
+		} else if (strcmp(arg, "--ordering") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (strcmp(name, "none") == 0) {
+				ordering = MoveOrdering::NONE;
+			} else if (strcmp(name, "windows") == 0) {
+				ordering = MoveOrdering::WINDOWS;
+			} else {
+				fprintf(stderr, "Unknown move ordering: %s\n", name);
+				return false;
+			}
+		} else if (strcmp(arg, "--leaf-init") == 0 && i + 1 < argc) {
+			const char* name = argv[++i];
+			if (strcmp(name, "unit") == 0) {
+				leafInitialization = LeafInitialization::UNIT;
+			} else if (strcmp(name, "mobility") == 0) {
+				leafInitialization = LeafInitialization::MOBILITY;
+			} else {
+				fprintf(stderr, "Unknown leaf initialization: %s\n", name);
+				return false;
+			}
+		} else if (strcmp(arg, "--epsilon") == 0 && i + 1 < argc) {
+			epsilon = strtod(argv[++i], nullptr);
+			if (epsilon < 0) {
+				fprintf(stderr, "Invalid epsilon: %s\n", argv[i]);
+				return false;
+			}
+		} else if (strcmp(arg, "--no-threat-search") == 0) {
+			threatSearch = false;
+		} else if (strcmp(arg, "--table-size") == 0 && i + 1 < argc) {
+			long megabytes = strtol(argv[++i], nullptr, 10);
+			if (megabytes <= 0) {
+				fprintf(stderr, "Invalid table size: %s\n", argv[i]);
+				return false;
+			}
+			tableSizeInBytes = (std::size_t)megabytes * MEGABYTE;
+		} else if (strcmp(arg, "--threads") == 0 && i + 1 < argc) {
+			long count = strtol(argv[++i], nullptr, 10);
+			if (count < 0) {
+				fprintf(stderr, "Invalid thread count: %s\n", argv[i]);
+				return false;
+			}
+			threads = parseThreadCount(count);
+		} else if (strcmp(arg, "--scaling") == 0 && i + 1 < argc) {
+			long count = strtol(argv[++i], nullptr, 10);
+			if (count < 0) {
+				fprintf(stderr, "Invalid thread count: %s\n", argv[i]);
+				return false;
+			}
+			scalingThreads = parseThreadCount(count);
+		} else if (strcmp(arg, "--batch") == 0) {
+			batch = true;
+		} else if (strcmp(arg, "--server") == 0 && i + 1 < argc) {
+			long port = strtol(argv[++i], nullptr, 10);
+			if (port <= 0 || port > 65535) {
+				fprintf(stderr, "Invalid port: %s\n", argv[i]);
+				return false;
+			}
+			serverPort = (int)port;
+		} else if (strcmp(arg, "--benchmark") == 0 && i + 1 < argc) {
+			benchmarkPath = argv[++i];
+		} else if (strcmp(arg, "--db") == 0 && i + 1 < argc) {
+			databasePath = argv[++i];
+		} else if (strcmp(arg, "--merge-db") == 0 && i + 1 < argc) {
+			mergePath = argv[++i];
+		} else if (strcmp(arg, "--json") == 0) {
+			json = true;
+		} else if (strcmp(arg, "--stats") == 0) {
+			printStats = true;
+		} else if (strcmp(arg, "--stats-total") == 0) {
+			printStatsTotal = true;
+		} else if (strcmp(arg, "--timeout") == 0 && i + 1 < argc) {
+			timeLimit = strtod(argv[++i], nullptr);
+			if (timeLimit <= 0) {
+				fprintf(stderr, "Invalid timeout: %s\n", argv[i]);
+				return false;
+			}
+		} else if (strcmp(arg, "--max-nodes") == 0 && i + 1 < argc) {
+			long long nodes = strtoll(argv[++i], nullptr, 10);
+			if (nodes <= 0) {
+				fprintf(stderr, "Invalid node limit: %s\n", argv[i]);
+				return false;
+			}
+			nodeLimit = (uint64_t)nodes;
+		} else if (strcmp(arg, "--max-memory") == 0 && i + 1 < argc) {
+			long megabytes = strtol(argv[++i], nullptr, 10);
+			if (megabytes <= 0) {
+				fprintf(stderr, "Invalid memory limit: %s\n", argv[i]);
+				return false;
+			}
+			memoryLimit = (std::size_t)megabytes * MEGABYTE;
+		} else if (strcmp(arg, "--retries") == 0 && i + 1 < argc) {
+			long count = strtol(argv[++i], nullptr, 10);
+			if (count < 0) {
+				fprintf(stderr, "Invalid retry count: %s\n", argv[i]);
+				return false;
+			}
+			retries = (int)count;
+		} else {
+			fprintf(stderr, "Unknown option: %s\n", arg);
+			return false;
+		}
+	}
+	if (mergePath != nullptr && databasePath == nullptr) {
+		fprintf(stderr, "--merge-db requires --db <output>\n");
+		return false;
+	}
+	if (threads > 1 && algorithm == Algorithm::PNS && !batch && serverPort == 0) {
+		fprintf(stderr, "--threads only parallelizes DFPN; PNS requests run on one thread (add --dfpn)\n");
+	}
+	if (retries > 0 && timeLimit == 0 && nodeLimit == 0 && memoryLimit == 0) {
+		fprintf(stderr, "--retries requires --timeout, --max-nodes or --max-memory\n");
+		return false;
+	}
+	if ((printStats || printStatsTotal) && !SearchStats::isEnabled()) {
+		fprintf(stderr, "Search statistics are not compiled in; rebuild with NMK_SEARCH_STATS defined\n");
+		printStats = false;
+		printStatsTotal = false;
+	}
+	return true;
+}
+
+void SolverOptions::printUsage(const char* program) {
+	fprintf(stderr, "Usage: %s [--pns | --dfpn] [--ordering none|windows] [--leaf-init unit|mobility] [--epsilon <value>] [--no-threat-search] [--table-size <MB>] [--threads <N> (parallel DFPN, or workers with --batch/--server)] [--scaling <N>] [--batch] [--server <port>] [--timeout <seconds>] [--max-nodes <N>] [--max-memory <MB>] [--retries <N>] [--benchmark <suite> [--json]] [--db <path> [--merge-db <path>]] [--stats] [--stats-total]\n", program);
+}
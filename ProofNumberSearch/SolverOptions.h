@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class Algorithm {
+	PNS, DFPN
+};
+
+enum class MoveOrdering {
+	NONE, WINDOWS
+};
+
+enum class LeafInitialization {
+	UNIT, MOBILITY
+};
+
+struct SolverOptions {
+	SolverOptions();
+	Algorithm algorithm;
+	MoveOrdering ordering;
+	LeafInitialization leafInitialization;
+	double epsilon;
+	bool threatSearch;
+	std::size_t tableSizeInBytes;
+	int threads;
+	int scalingThreads;
+	bool batch;
+	int serverPort;
+	double timeLimit;
+	uint64_t nodeLimit;
+	std::size_t memoryLimit;
+	int retries;
+	const char* benchmarkPath;
+	const char* databasePath;
+	const char* mergePath;
+	bool json;
+	bool printStats;
+	bool printStatsTotal;
+	bool parse(int argc, char** argv);
+	static void printUsage(const char* program);
+};
@@ -0,0 +1,167 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "SolverServer.h"
+#include "InputReader.h"
+#include "SolveRequest.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string.h>
+#include <thread>
+
+SolverServer::SolverServer(const SolverOptions& options) : options(options), workerCount(std::max(1, options.threads)), pendingStart(0), pendingCount(0),
+	connectionCount(0) {
+	this->options.threads = 1;
+	this->options.tableSizeInBytes = options.tableSizeInBytes / workerCount;
+}
+
+bool SolverServer::run() {
+	if (options.databasePath != nullptr && !database.open(options.databasePath)) {
+		return false;
+	}
+	if (!Socket::startup() || !listener.listen(options.serverPort)) {
+		return false;
+	}
+	fprintf(stderr, "Listening on 127.0.0.1:%d with %d workers\n", options.serverPort, workerCount);
+	std::thread* workers = new std::thread[workerCount];
+	for (int i = 0; i < workerCount; i++) {
+		workers[i] = std::thread(&SolverServer::work, this);
+	}
+	Socket* connection;
+	while (listener.accept(connection)) {
+		if (connection == nullptr) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(SERVER_ACCEPT_RETRY_MS));
+		} else if (!addConnection(connection)) {
+			fprintf(stderr, "Refusing a connection: %d connections are already open\n", SERVER_MAX_CONNECTIONS);
+			delete connection;
+		} else {
+			std::thread(&SolverServer::serve, this, connection).detach();
+		}
+	}
+	fprintf(stderr, "Stopped accepting connections\n");
+	closeConnections();
+	for (int i = 0; i < workerCount; i++) {
+		push(nullptr);
+	}
+	for (int i = 0; i < workerCount; i++) {
+		workers[i].join();
+	}
+	delete[] workers;
+	return false;
+}
+
+void SolverServer::work() {
+	TranspositionTable table(options.tableSizeInBytes);
+	Job* job;
+	while ((job = pop()) != nullptr) {
+		solve(*job, table);
+		finish(job);
+	}
+}
+
+void SolverServer::solve(Job& job, TranspositionTable& table) {
+	SolveRequest* request = job.request;
+	SolverOptions requestOptions = options;
+	requestOptions.algorithm = request->algorithm;
+	table.newSearch();
+	NmkEngine engine(request->board, request->minToWin, request->player, table, requestOptions);
+	engine.setTimeLimit(options.timeLimit);
+	engine.setReportMove(request->reportMove);
+	engine.setDatabase(options.databasePath != nullptr ? &database : nullptr);
+	engine.writeResult(engine.solveWithRetries(options.retries), job.response, MAX_RESPONSE_LENGTH);
+	if (options.printStats) {
+		std::lock_guard<std::mutex> guard(outputLock);
+		engine.getStats().print(stderr, request->command);
+	}
+}
+
+void SolverServer::serve(Socket* connection) {
+	InputReader reader(*connection);
+	SolveRequest* request;
+	Job job;
+	while ((request = SolveRequest::read(reader, options.algorithm)) != nullptr) {
+		if (!request->valid) {
+			snprintf(job.response, MAX_RESPONSE_LENGTH, "Invalid command: %s\n", request->command);
+		} else {
+			job.request = request;
+			job.done = false;
+			push(&job);
+			waitFor(job);
+		}
+		delete request;
+		if (!connection->send(job.response, (int)strlen(job.response))) {
+			break;
+		}
+	}
+	if (reader.hasFailed()) {
+		snprintf(job.response, MAX_RESPONSE_LENGTH, "%s\n", reader.getError());
+		connection->send(job.response, (int)strlen(job.response));
+	}
+	removeConnection(connection);
+	delete connection;
+}
+
+void SolverServer::push(Job* job) {
+	std::unique_lock<std::mutex> guard(queueLock);
+	while (pendingCount == SERVER_QUEUE_CAPACITY) {
+		queueChanged.wait(guard);
+	}
+	pending[(pendingStart + pendingCount++) % SERVER_QUEUE_CAPACITY] = job;
+	queueChanged.notify_all();
+}
+
+SolverServer::Job* SolverServer::pop() {
+	std::unique_lock<std::mutex> guard(queueLock);
+	while (pendingCount == 0) {
+		queueChanged.wait(guard);
+	}
+	Job* job = pending[pendingStart];
+	pendingStart = (pendingStart + 1) % SERVER_QUEUE_CAPACITY;
+	pendingCount--;
+	queueChanged.notify_all();
+	return job;
+}
+
+void SolverServer::finish(Job* job) {
+	std::lock_guard<std::mutex> guard(queueLock);
+	job->done = true;
+	queueChanged.notify_all();
+}
+
+void SolverServer::waitFor(Job& job) {
+	std::unique_lock<std::mutex> guard(queueLock);
+	while (!job.done) {
+		queueChanged.wait(guard);
+	}
+}
+
+bool SolverServer::addConnection(Socket* connection) {
+	std::lock_guard<std::mutex> guard(connectionLock);
+	if (connectionCount == SERVER_MAX_CONNECTIONS) {
+		return false;
+	}
+	connections[connectionCount++] = connection;
+	return true;
+}
+
+void SolverServer::removeConnection(Socket* connection) {
+	std::lock_guard<std::mutex> guard(connectionLock);
+	for (int i = 0; i < connectionCount; i++) {
+		if (connections[i] == connection) {
+			connections[i] = connections[--connectionCount];
+			break;
+		}
+	}
+	connectionsChanged.notify_all();
+}
+
+void SolverServer::closeConnections() {
+	std::unique_lock<std::mutex> guard(connectionLock);
+	for (int i = 0; i < connectionCount; i++) {
+		connections[i]->shutdown();
+	}
+	while (connectionCount > 0) {
+		connectionsChanged.wait(guard);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Engine.h"
+#include "SolvedDatabase.h"
+#include "SolverOptions.h"
+#include "Socket.h"
+#include <condition_variable>
+#include <mutex>
+
+#define SERVER_QUEUE_CAPACITY 64
+#define SERVER_MAX_CONNECTIONS 256
+#define SERVER_ACCEPT_RETRY_MS 100
+
+struct SolveRequest;
+class TranspositionTable;
+
+class SolverServer {
+public:
+	explicit SolverServer(const SolverOptions& options);
+	bool run();
+private:
+	struct Job {
+		SolveRequest* request;
+		char response[MAX_RESPONSE_LENGTH];
+		bool done;
+	};
+	SolverOptions options;
+	SolvedDatabase database;
+	Socket listener;
+	int workerCount;
+	Job* pending[SERVER_QUEUE_CAPACITY];
+	int pendingStart;
+	int pendingCount;
+	Socket* connections[SERVER_MAX_CONNECTIONS];
+	int connectionCount;
+	std::mutex queueLock;
+	std::condition_variable queueChanged;
+	std::mutex connectionLock;
+	std::condition_variable connectionsChanged;
+	std::mutex outputLock;
+	void work();
+	void solve(Job& job, TranspositionTable& table);
+	void serve(Socket* connection);
+	void push(Job* job);
+	Job* pop();
+	void finish(Job* job);
+	void waitFor(Job& job);
+	bool addConnection(Socket* connection);
+	void removeConnection(Socket* connection);
+	void closeConnections();
+};
@@ -0,0 +1,97 @@
+#include "ThreatSet.h"
+#include "BitUtils.h"
+#include <assert.h>
+#include <cstring>
+
+ThreatSet::ThreatSet(int width, int height) : bits(inlineBits), ownsBits(false), wordCount((width * height + 63) / 64), width(width) {
+	if (wordCount > THREAT_SET_INLINE_WORDS) {
+		bits = new uint64_t[2 * wordCount];
+		ownsBits = true;
+	}
+	memset(bits, 0, 2 * wordCount * sizeof(uint64_t));
+	counts[0] = 0;
+	counts[1] = 0;
+}
+
+ThreatSet::ThreatSet(const ThreatSet& other) : bits(inlineBits), ownsBits(false), wordCount(other.wordCount), width(other.width) {
+	if (wordCount > THREAT_SET_INLINE_WORDS) {
+		bits = new uint64_t[2 * wordCount];
+		ownsBits = true;
+	}
+	memcpy(bits, other.bits, 2 * wordCount * sizeof(uint64_t));
+	counts[0] = other.counts[0];
+	counts[1] = other.counts[1];
+}
+
+ThreatSet::ThreatSet(const ThreatSet& other, Arena& arena) : bits(inlineBits), ownsBits(false), wordCount(other.wordCount), width(other.width) {
+	if (wordCount > THREAT_SET_INLINE_WORDS) {
+		bits = arena.allocateArray<uint64_t>(2 * wordCount);
+	}
+	memcpy(bits, other.bits, 2 * wordCount * sizeof(uint64_t));
+	counts[0] = other.counts[0];
+	counts[1] = other.counts[1];
+}
+
+ThreatSet::~ThreatSet() {
+	if (ownsBits) {
+		delete[] bits;
+	}
+}
+
+bool ThreatSet::contains(const Player& player, int x, int y) const {
+	int index = y * width + x;
+	return (planeFor(player)[index >> 6] >> (index & 63)) & 1;
+}
+
+void ThreatSet::add(const Player& player, int x, int y) {
+	int index = y * width + x;
+	uint64_t& word = planeFor(player)[index >> 6];
+	uint64_t mask = 1ULL << (index & 63);
+	if ((word & mask) == 0) {
+		word |= mask;
+		counts[playerIndex(player)]++;
+	}
+}
+
+void ThreatSet::remove(const Player& player, int x, int y) {
+	int index = y * width + x;
+	uint64_t& word = planeFor(player)[index >> 6];
+	uint64_t mask = 1ULL << (index & 63);
+	if ((word & mask) != 0) {
+		word &= ~mask;
+		counts[playerIndex(player)]--;
+	}
+}
+
+int ThreatSet::sizeByPlayer(const Player& player) const {
+	return counts[playerIndex(player)];
+}
+
+int ThreatSet::findNext(const Player& player, int start) const {
+	const uint64_t* plane = planeFor(player);
+	int word = start >> 6;
+	if (word >= wordCount) {
+		return -1;
+	}
+	uint64_t remaining = plane[word] & (~0ULL << (start & 63));
+	while (remaining == 0) {
+		if (++word >= wordCount) {
+			return -1;
+		}
+		remaining = plane[word];
+	}
+	return word * 64 + countTrailingZeros(remaining);
+}
+
+int ThreatSet::getWidth() const {
+	return width;
+}
+
+uint64_t* ThreatSet::planeFor(const Player& player) const {
+	return bits + playerIndex(player) * wordCount;
+}
+
+int ThreatSet::playerIndex(const Player& player) {
+	assert(player != Player::NONE);
+	return player == Player::FIRST ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Arena.h"
+#include "Player.h"
+#include <cstdint>
+
+#define THREAT_SET_INLINE_WORDS 4
+
+class Arena;
+class Player;
+
+class ThreatSet {
+public:
+	ThreatSet(int width, int height);
+	ThreatSet(const ThreatSet& other);
+	ThreatSet(const ThreatSet& other, Arena& arena);
+	~ThreatSet();
+	ThreatSet& operator=(const ThreatSet& other) = delete;
+	bool contains(const Player& player, int x, int y) const;
+	void add(const Player& player, int x, int y);
+	void remove(const Player& player, int x, int y);
+	int sizeByPlayer(const Player& player) const;
+	int findNext(const Player& player, int start) const;
+	int getWidth() const;
+private:
+	uint64_t inlineBits[2 * THREAT_SET_INLINE_WORDS];
+	uint64_t* bits;
+	bool ownsBits;
+	int wordCount;
+	int width;
+	int counts[2];
+	uint64_t* planeFor(const Player& player) const;
+	static int playerIndex(const Player& player);
+};
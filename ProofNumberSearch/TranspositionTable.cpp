@@ -0,0 +1,143 @@
+#include "TranspositionTable.h"
+#include <cstring>
+
+#define PRIORITY_CURRENT_SEARCH (1ULL << 33)
+#define PRIORITY_SOLVED (1ULL << 32)
+
+TranspositionTable::TranspositionTable(std::size_t sizeInBytes) : buckets(nullptr), bucketMask(0), generation(1), shared(false), busy(nullptr), probes(0), hits(0) {
+	std::size_t bucketCount = 1;
+	while (bucketCount * 2 * sizeof(Bucket) <= sizeInBytes) {
+		bucketCount *= 2;
+	}
+	buckets = new Bucket[bucketCount];
+	bucketMask = bucketCount - 1;
+	busy = new std::atomic<uint16_t>[TABLE_BUSY_SLOTS];
+	for (int i = 0; i < TABLE_BUSY_SLOTS; i++) {
+		busy[i].store(0, std::memory_order_relaxed);
+	}
+	clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+	delete[] buckets;
+	delete[] busy;
+}
+
+bool TranspositionTable::Entry::isSolved() const {
+	return proof == 0 || disproof == 0;
+}
+
+bool TranspositionTable::lookup(uint64_t key, Entry& result) {
+	probes.fetch_add(1, std::memory_order_relaxed);
+	std::size_t index = key & bucketMask;
+	bool found;
+	if (shared) {
+		std::lock_guard<std::mutex> guard(locks[index % TABLE_LOCK_STRIPES]);
+		found = find(buckets[index], key, result);
+	} else {
+		found = find(buckets[index], key, result);
+	}
+	if (found) {
+		hits.fetch_add(1, std::memory_order_relaxed);
+	}
+	return found;
+}
+
+void TranspositionTable::store(uint64_t key, int proof, int disproof, ProofValue value, uint32_t work) {
+	std::size_t index = key & bucketMask;
+	if (shared) {
+		std::lock_guard<std::mutex> guard(locks[index % TABLE_LOCK_STRIPES]);
+		replace(buckets[index], key, proof, disproof, value, work);
+	} else {
+		replace(buckets[index], key, proof, disproof, value, work);
+	}
+}
+
+void TranspositionTable::setShared(bool isShared) {
+	shared = isShared;
+}
+
+void TranspositionTable::enter(uint64_t key) {
+	busy[key & (TABLE_BUSY_SLOTS - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TranspositionTable::leave(uint64_t key) {
+	busy[key & (TABLE_BUSY_SLOTS - 1)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+int TranspositionTable::getBusy(uint64_t key) const {
+	return busy[key & (TABLE_BUSY_SLOTS - 1)].load(std::memory_order_relaxed);
+}
+
+void TranspositionTable::newSearch() {
+	generation++;
+	if (generation == 0) {
+		generation = 1;
+	}
+}
+
+void TranspositionTable::clear() {
+	memset(buckets, 0, (bucketMask + 1) * sizeof(Bucket));
+	probes = 0;
+	hits = 0;
+}
+
+std::size_t TranspositionTable::getCapacity() const {
+	return (bucketMask + 1) * TABLE_BUCKET_SIZE;
+}
+
+std::size_t TranspositionTable::getProbes() const {
+	return probes;
+}
+
+std::size_t TranspositionTable::getHits() const {
+	return hits;
+}
+
+bool TranspositionTable::find(const Bucket& bucket, uint64_t key, Entry& result) {
+	for (int i = 0; i < TABLE_BUCKET_SIZE; i++) {
+		const Entry& entry = bucket.entries[i];
+		if (entry.generation != 0 && entry.key == key) {
+			result = entry;
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::replace(Bucket& bucket, uint64_t key, int proof, int disproof, ProofValue value, uint32_t work) {
+	Entry* victim = &bucket.entries[0];
+	for (int i = 0; i < TABLE_BUCKET_SIZE; i++) {
+		Entry& entry = bucket.entries[i];
+		if (entry.generation != 0 && entry.key == key) {
+			if (entry.isSolved() && proof != 0 && disproof != 0) {
+				return;
+			}
+			victim = &entry;
+			break;
+		}
+		if (replacementPriority(entry) < replacementPriority(*victim)) {
+			victim = &entry;
+		}
+	}
+	victim->key = key;
+	victim->proof = proof;
+	victim->disproof = disproof;
+	victim->work = work;
+	victim->value = value;
+	victim->generation = generation;
+}
+
+uint64_t TranspositionTable::replacementPriority(const Entry& entry) const {
+	if (entry.generation == 0) {
+		return 0;
+	}
+	uint64_t priority = entry.work;
+	if (entry.isSolved()) {
+		priority += PRIORITY_SOLVED;
+	}
+	if (entry.generation == generation) {
+		priority += PRIORITY_CURRENT_SEARCH;
+	}
+	return priority;
+}
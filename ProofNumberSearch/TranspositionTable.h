@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#define DEFAULT_TABLE_SIZE_MB 64
+#define TABLE_BUCKET_SIZE 4
+#define TABLE_LOCK_STRIPES 1024
+#define TABLE_BUSY_SLOTS (1 << 16)
+
+enum class ProofValue : uint8_t {
+	DISPROVEN, PROVEN, UNKNOWN, DRAWN
+};
+
+class TranspositionTable {
+public:
+	struct Entry {
+		uint64_t key;
+		int proof;
+		int disproof;
+		uint32_t work;
+		ProofValue value;
+		uint8_t generation;
+		bool isSolved() const;
+	};
+	explicit TranspositionTable(std::size_t sizeInBytes);
+	~TranspositionTable();
+	TranspositionTable(const TranspositionTable& other) = delete;
+	TranspositionTable& operator=(const TranspositionTable& other) = delete;
+	bool lookup(uint64_t key, Entry& result);
+	void store(uint64_t key, int proof, int disproof, ProofValue value, uint32_t work);
+	void setShared(bool isShared);
+	void enter(uint64_t key);
+	void leave(uint64_t key);
+	int getBusy(uint64_t key) const;
+	void newSearch();
+	void clear();
+	std::size_t getCapacity() const;
+	std::size_t getProbes() const;
+	std::size_t getHits() const;
+private:
+	struct Bucket {
+		Entry entries[TABLE_BUCKET_SIZE];
+	};
+	Bucket* buckets;
+	std::size_t bucketMask;
+	uint8_t generation;
+	bool shared;
+	std::mutex locks[TABLE_LOCK_STRIPES];
+	std::atomic<uint16_t>* busy;
+	std::atomic<std::size_t> probes;
+	std::atomic<std::size_t> hits;
+	bool find(const Bucket& bucket, uint64_t key, Entry& result);
+	void replace(Bucket& bucket, uint64_t key, int proof, int disproof, ProofValue value, uint32_t work);
+	uint64_t replacementPriority(const Entry& entry) const;
+};
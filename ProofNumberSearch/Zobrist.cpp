@@ -0,0 +1,33 @@
+#include "Zobrist.h"
+#include <assert.h>
+
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+#define ZOBRIST_SIDE_SEED 0xD1B54A32D192ED03ULL
+#define ZOBRIST_CONFIG_SEED 0x8CB92BA72F3D8DD7ULL
+#define ZOBRIST_GOAL_SEED 0xF1357AEA2E62A9C5ULL
+
+uint64_t Zobrist::cellKey(int index, const Player& player) {
+	assert(player != Player::NONE);
+	return mix(ZOBRIST_SEED + ((uint64_t)index << 1) + (player == Player::FIRST ? 0 : 1));
+}
+
+uint64_t Zobrist::sideKey(const Player& player) {
+	return mix(ZOBRIST_SIDE_SEED + player.valueAsInt());
+}
+
+uint64_t Zobrist::configKey(int width, int height, int k, const Player& player) {
+	uint64_t key = mix(ZOBRIST_CONFIG_SEED + (uint64_t)width);
+	key = mix(key ^ (uint64_t)height);
+	key = mix(key ^ (uint64_t)k);
+	return mix(key ^ (uint64_t)player.valueAsInt());
+}
+
+uint64_t Zobrist::goalKey(int goal) {
+	return goal == 0 ? 0 : mix(ZOBRIST_GOAL_SEED + (uint64_t)goal);
+}
+
+uint64_t Zobrist::mix(uint64_t value) {
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+	return value ^ (value >> 31);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Player.h"
+#include <cstdint>
+
+class Player;
+
+class Zobrist {
+public:
+	static uint64_t cellKey(int index, const Player& player);
+	static uint64_t sideKey(const Player& player);
+	static uint64_t configKey(int width, int height, int k, const Player& player);
+	static uint64_t goalKey(int goal);
+private:
+	static uint64_t mix(uint64_t value);
+};
@@ -1,7 +1,31 @@
+#include "Benchmark.h"
 #include "InputHandler.h"
+#include "SolvedDatabase.h"
+#include "SolverOptions.h"
+#include "SolverServer.h"
 
-int main() {
-	InputHandler handler;
-	handler.handle();
-	return 0;
+int main(int argc, char** argv) {
+	SolverOptions options;
+	if (!options.parse(argc, argv)) {
+		SolverOptions::printUsage(argv[0]);
+		return 1;
+	}
+	if (options.mergePath != nullptr) {
+		SolvedDatabase database;
+		if (!database.open(options.databasePath) || !database.merge(options.mergePath)) {
+			return 1;
+		}
+		printf("%zu positions in %s\n", database.getSize(), options.databasePath);
+		return 0;
+	}
+	if (options.benchmarkPath != nullptr) {
+		Benchmark benchmark(options);
+		return benchmark.run(options.benchmarkPath) ? 0 : 1;
+	}
+	if (options.serverPort > 0) {
+		SolverServer server(options);
+		return server.run() ? 0 : 1;
+	}
+	InputHandler handler(options);
+	return handler.handle() ? 0 : 1;
 }
\ No newline at end of file